@@ -0,0 +1,543 @@
+#pragma once
+#include "Storage.h"
+#include "EvictionPolicy.h"
+#include "TimingWheel.h"
+#include "CacheStats.h"
+#include "Snapshot.h"
+#include "MissRatioCurve.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <utility>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+// Result of a batch read: found entries plus the keys the caller must fetch
+template <typename K, typename V>
+struct MultiGetResult {
+    vector<pair<K, V>> hits;
+    vector<K> missing;
+};
+
+// Cache Implementation
+// By default maxSize is an entry count. With a weigher, maxSize is a budget
+// in the weigher's unit (e.g. bytes) and put() evicts until the entry fits.
+// Entries may also expire: after a per-entry TTL, a default write TTL, or
+// after not being read for the access TTL. Expired entries are dropped lazily
+// by get() and proactively by cleanUp(), which a maintenance tick calls.
+// enableStats() turns on hit/miss/eviction/load counters and policy timing.
+// multiGet()/multiPut() handle a batch of keys in one call.
+// snapshot()/restore() persist entries plus eviction order for warm restarts.
+// spillTo() adds a second tier (e.g. DiskStorage): evicted entries move there
+// and a memory miss checks it before reporting a miss.
+// enableMissRatioCurve() samples reads to estimate hit ratios at other sizes.
+template <typename K, typename V>
+class Cache {
+public:
+    using Weigher = function<size_t(const K&, const V&)>;
+
+private:
+    unique_ptr<Storage<K, V>> storage;
+    unique_ptr<EvictionPolicy<K>> policy;
+    size_t maxSize;
+    Weigher weigher;
+    size_t totalWeight = 0;
+    long long writeTtlMillis = 0;
+    long long accessTtlMillis = 0;
+    unique_ptr<TimingWheel<K>> wheel; // created on first use of expiry
+    unordered_map<K, long long> writeDeadlines; // per-entry or write TTL deadline, if any
+    shared_ptr<CacheStats> stats;     // null unless enableStats() was called
+    unique_ptr<Storage<K, V>> secondTier; // null unless spillTo() was called
+    // Absolute deadlines of spilled entries that had one (LLONG_MAX: none)
+    struct SpilledDeadline {
+        long long expiresAt;
+        long long writeDeadline;
+    };
+    unordered_map<K, SpilledDeadline> spilledDeadlines;
+    unique_ptr<MissRatioCurve<K>> mrc;    // null unless enableMissRatioCurve() was called
+    function<long long()> clock = [] {
+        return chrono::duration_cast<chrono::milliseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+    };
+
+    void record(CacheStats::Counter counter) {
+        if (stats) stats->record(counter);
+    }
+
+    // Runs one EvictionPolicy call, charging its time to PolicyNanos
+    template <typename F>
+    auto timedPolicy(F call) {
+        ScopedStatsTimer timer(stats.get(), CacheStats::PolicyNanos);
+        return call();
+    }
+
+    size_t weightOf(const K& key, const V& value) const {
+        return weigher ? weigher(key, value) : 1;
+    }
+
+    void dropFromStorage(const K& key) {
+        if (weigher) {
+            if (V* value = storage->find(key)) {
+                totalWeight -= weigher(key, *value);
+            }
+        } else {
+            --totalWeight;
+        }
+        storage->remove(key);
+        if (wheel) {
+            writeDeadlines.erase(key);
+        }
+    }
+
+    void evictOne() {
+        K evictKey = timedPolicy([&] { return policy->evict(); });
+        record(CacheStats::Evictions);
+        optional<long long> deadline = wheel ? wheel->deadlineOf(evictKey) : nullopt;
+        // Expired victims are dropped, not spilled
+        if (secondTier && (!deadline || *deadline > clock())) {
+            if (V* value = storage->find(evictKey)) {
+                secondTier->add(evictKey, *value);
+                if (deadline) {
+                    auto it = writeDeadlines.find(evictKey);
+                    spilledDeadlines[evictKey] = {*deadline, it != writeDeadlines.end() ? it->second : LLONG_MAX};
+                }
+            }
+        }
+        if (wheel) {
+            wheel->cancel(evictKey);
+        }
+        dropFromStorage(evictKey);
+    }
+
+    void removeFromSecondTier(const K& key) {
+        secondTier->remove(key);
+        spilledDeadlines.erase(key);
+    }
+
+    // Memory miss: move the entry back up from the second tier if it is
+    // there and still live. It keeps its write deadline; the read restarts
+    // its access TTL.
+    V* promoteFromSecondTier(const K& key) {
+        V* spilled = secondTier->find(key);
+        if (!spilled) {
+            return nullptr;
+        }
+        SpilledDeadline deadline{LLONG_MAX, LLONG_MAX};
+        if (auto it = spilledDeadlines.find(key); it != spilledDeadlines.end()) {
+            deadline = it->second;
+        }
+        bool timed = deadline.expiresAt != LLONG_MAX || accessTtlMillis > 0;
+        long long now = timed ? clock() : 0;
+        if (deadline.expiresAt <= now) {
+            removeFromSecondTier(key);
+            return nullptr;
+        }
+        V value = *spilled;
+        size_t weight = weightOf(key, value);
+        if (!makeRoomFor(weight)) { // may spill other entries down
+            return secondTier->find(key);
+        }
+        timedPolicy([&] { policy->add(key); });
+        storage->add(key, value);
+        totalWeight += weight;
+        removeFromSecondTier(key); // only once the entry is back in memory
+        if (deadline.writeDeadline != LLONG_MAX) {
+            writeDeadlines[key] = deadline.writeDeadline;
+        }
+        if (timed) {
+            rescheduleExpiry(key, now);
+        }
+        return storage->find(key);
+    }
+
+    void expire(const K& key) {
+        timedPolicy([&] { policy->remove(key); });
+        dropFromStorage(key);
+    }
+
+    // Evicts until an entry of this weight fits. Returns false for an entry
+    // that can never fit, so the cache is not flushed for it.
+    bool makeRoomFor(size_t weight) {
+        if (maxSize > 0 && weight > maxSize) {
+            return false;
+        }
+        while (maxSize > 0 && storage->size() > 0 && totalWeight + weight > maxSize) {
+            evictOne();
+        }
+        return true;
+    }
+
+    // storage->find() that also honours expiry (dropping expired entries)
+    // promote = false only looks in memory.
+    V* findLive(const K& key, bool promote = true) {
+        V* value = storage->find(key);
+        if (!value) {
+            return promote && secondTier ? promoteFromSecondTier(key) : nullptr;
+        }
+        if (!wheel) {
+            return value;
+        }
+        long long now = clock();
+        if (wheel->isExpired(key, now)) {
+            wheel->cancel(key);
+            expire(key);
+            return nullptr;
+        }
+        if (accessTtlMillis > 0) {
+            rescheduleExpiry(key, now);
+        }
+        return value;
+    }
+
+    TimingWheel<K>& timers() {
+        if (!wheel) {
+            wheel = make_unique<TimingWheel<K>>(1, clock());
+        }
+        return *wheel;
+    }
+
+    // The earlier of the write deadline and now + access TTL
+    void rescheduleExpiry(const K& key, long long now) {
+        long long deadline = LLONG_MAX;
+        if (auto it = writeDeadlines.find(key); it != writeDeadlines.end()) {
+            deadline = it->second;
+        }
+        if (accessTtlMillis > 0) {
+            deadline = min(deadline, now + accessTtlMillis);
+        }
+        if (deadline != LLONG_MAX) {
+            timers().schedule(key, deadline);
+        } else if (wheel) {
+            wheel->cancel(key);
+        }
+    }
+
+    // On write. ttlMillis <= 0 means "use the cache-wide write TTL"; reads
+    // never push a write deadline out.
+    void scheduleExpiry(const K& key, long long ttlMillis) {
+        long long ttl = ttlMillis > 0 ? ttlMillis : writeTtlMillis;
+        if (ttl <= 0 && accessTtlMillis <= 0 && !wheel) {
+            return;
+        }
+        long long now = clock();
+        if (ttl > 0) {
+            writeDeadlines[key] = now + ttl;
+        } else {
+            writeDeadlines.erase(key);
+        }
+        rescheduleExpiry(key, now);
+    }
+
+public:
+    Cache(Storage<K, V>* stor, EvictionPolicy<K>* pol, size_t size)
+        : storage(stor), policy(pol), maxSize(size) {}
+
+    Cache(Storage<K, V>* stor, EvictionPolicy<K>* pol, size_t maxWeight, Weigher weigh)
+        : storage(stor), policy(pol), maxSize(maxWeight), weigher(std::move(weigh)) {}
+
+    // Default TTL for entries written by put()
+    void expireAfterWrite(long long millis) {
+        writeTtlMillis = millis;
+    }
+
+    // Entries expire once not read for this long; get() pushes the deadline out
+    void expireAfterAccess(long long millis) {
+        accessTtlMillis = millis;
+    }
+
+    // Millisecond clock used for expiry, e.g. a fake clock in tests.
+    // Set it before the first put with a TTL; pending timers are dropped.
+    void setClock(function<long long()> nowMillis) {
+        clock = std::move(nowMillis);
+        wheel.reset();
+        writeDeadlines.clear();
+        spilledDeadlines.clear();
+    }
+
+    void put(const K& key, const V& value) {
+        put(key, value, 0);
+    }
+
+    // Put with a per-entry TTL that overrides the cache-wide write TTL; the
+    // access TTL still applies, and the earlier deadline wins
+    void put(const K& key, const V& value, long long ttlMillis) {
+        size_t weight = weightOf(key, value);
+        if (V* existing = storage->find(key)) {
+            size_t oldWeight = weightOf(key, *existing);
+            if (maxSize == 0 || totalWeight - oldWeight + weight <= maxSize) {
+                timedPolicy([&] { policy->markAccessed(key); });
+                totalWeight = totalWeight - oldWeight + weight;
+                *existing = value;
+                scheduleExpiry(key, ttlMillis);
+                return;
+            }
+            // Grown past the budget: drop the old entry and insert like a new
+            // one, so the key cannot be its own eviction victim and a value
+            // that can never fit is rejected rather than kept
+            timedPolicy([&] { policy->remove(key); });
+            if (wheel) {
+                wheel->cancel(key);
+            }
+            dropFromStorage(key);
+        }
+        if (secondTier) {
+            removeFromSecondTier(key); // a key lives in one tier only
+        }
+        if (!makeRoomFor(weight)) {
+            return;
+        }
+        timedPolicy([&] { policy->add(key); });
+        storage->add(key, value);
+        totalWeight += weight;
+        scheduleExpiry(key, ttlMillis);
+    }
+
+    // get() only reads when both storage lookups and policy hits are read-only,
+    // so callers may then run gets concurrently under a shared lock. Expiry,
+    // a second tier and the miss ratio curve all write on reads; callers must
+    // ask again after enabling them (or after a put with a TTL).
+    bool supportsConcurrentGet() const {
+        return !wheel && writeTtlMillis <= 0 && accessTtlMillis <= 0 && !secondTier && !mrc
+            && storage->isFindThreadSafe() && policy->isMarkAccessedThreadSafe();
+    }
+
+    V get(const K& key) {
+        optional<V> value = getIfPresent(key);
+        if (!value) {
+            throw runtime_error("Key not found");
+        }
+        return *value;
+    }
+
+    // Like get(), but a miss returns nullopt instead of throwing.
+    // Callers re-checking after a miss they already counted pass recordMiss = false.
+    optional<V> getIfPresent(const K& key, bool recordMiss = true) {
+        if (mrc && recordMiss) mrc->recordAccess(key);
+        V* value = findLive(key);
+        if (!value) {
+            if (recordMiss) record(CacheStats::Misses);
+            return nullopt;
+        }
+        timedPolicy([&] { policy->markAccessed(key); });
+        record(CacheStats::Hits);
+        return *value;
+    }
+
+    // Batch read: prefetches every key, looks them all up, then applies the
+    // recency updates for the hits in a single policy call. Keys found in
+    // the second tier are promoted only after that call, since a promotion
+    // may evict a key the batch already hit; their hits come last.
+    MultiGetResult<K, V> multiGet(span<const K> keys) {
+        MultiGetResult<K, V> result;
+        for (const K& key : keys) {
+            storage->prefetch(key);
+            if (mrc) mrc->recordAccess(key);
+        }
+        vector<K> hitKeys;
+        hitKeys.reserve(keys.size());
+        vector<K> notResident;
+        for (const K& key : keys) {
+            if (V* value = findLive(key, false)) {
+                result.hits.emplace_back(key, *value);
+                hitKeys.push_back(key);
+            } else if (secondTier) {
+                notResident.push_back(key);
+            } else {
+                result.missing.push_back(key);
+            }
+        }
+        timedPolicy([&] { policy->markAccessedAll(hitKeys); });
+        for (const K& key : notResident) {
+            // Memory first: an earlier copy of the key in this batch may
+            // already have promoted it
+            if (V* value = findLive(key)) {
+                result.hits.emplace_back(key, *value);
+                timedPolicy([&] { policy->markAccessed(key); });
+            } else {
+                result.missing.push_back(key);
+            }
+        }
+        if (stats) {
+            stats->record(CacheStats::Hits, result.hits.size());
+            stats->record(CacheStats::Misses, result.missing.size());
+        }
+        return result;
+    }
+
+    void multiPut(span<const pair<K, V>> entries) {
+        for (const auto& [key, value] : entries) {
+            put(key, value);
+        }
+    }
+
+    // Use tier (taking ownership) for entries evicted from memory. Expired
+    // entries are dropped rather than spilled; spilled ones keep their
+    // deadline and are dropped if it passes before they are read again.
+    void spillTo(Storage<K, V>* tier) {
+        secondTier.reset(tier);
+    }
+
+    size_t spilledCount() const {
+        return secondTier ? secondTier->size() : 0;
+    }
+
+    // Read-through: on a miss call loader and cache its result. A throwing
+    // loader propagates to the caller and nothing is cached.
+    V getOrLoad(const K& key, const function<V(const K&)>& loader) {
+        if (optional<V> value = getIfPresent(key)) {
+            return *value;
+        }
+        V value = loadWithStats(key, loader);
+        put(key, value);
+        return value;
+    }
+
+    // Calls loader, recording its latency and outcome
+    V loadWithStats(const K& key, const function<V(const K&)>& loader) {
+        try {
+            V value = [&] {
+                ScopedStatsTimer timer(stats.get(), CacheStats::LoadNanos);
+                return loader(key);
+            }();
+            record(CacheStats::Loads);
+            return value;
+        } catch (...) {
+            record(CacheStats::LoadFailures);
+            throw;
+        }
+    }
+
+    // Record statistics into sink; several caches (e.g. shards) may share one
+    void enableStats(shared_ptr<CacheStats> sink = make_shared<CacheStats>()) {
+        stats = std::move(sink);
+    }
+
+    CacheStatsSnapshot statsSnapshot() const {
+        return stats ? stats->snapshot() : CacheStatsSnapshot{};
+    }
+
+    // Start sampling reads (a sampleRate fraction of keys) into a miss ratio
+    // curve. Sizes are entry counts, so weighted caches are not supported.
+    void enableMissRatioCurve(double sampleRate = 0.01) {
+        if (weigher) {
+            throw runtime_error("Miss ratio curve needs a count-based cache");
+        }
+        mrc = make_unique<MissRatioCurve<K>>(maxSize, sampleRate);
+    }
+
+    // Estimated hit ratios at 0.25x, 0.5x, 1x, 2x and 4x of maxSize
+    vector<HitRatioEstimate> estimateHitRatios() const {
+        if (!mrc) {
+            return {};
+        }
+        return mrc->estimate({maxSize / 4, maxSize / 2, maxSize, maxSize * 2, maxSize * 4});
+    }
+
+    // Write live entries, coldest first, with their policy weights. TTL
+    // deadlines are not saved; restored entries get the cache-wide TTL.
+    // The file is written next to path and renamed over it once synced, so
+    // an existing snapshot survives a failed or interrupted write.
+    template <typename KeySerializer = Serializer<K>, typename ValueSerializer = Serializer<V>>
+    void snapshot(const string& path) {
+        string tmpPath = path + ".tmp";
+        ofstream out(tmpPath, ios::binary | ios::trunc);
+        if (!out) {
+            throw runtime_error("Cannot write snapshot: " + tmpPath);
+        }
+        vector<pair<K, uint32_t>> order = timedPolicy([&] { return policy->exportOrder(); });
+        long long now = wheel ? clock() : 0;
+
+        string buffer;
+        Serializer<uint32_t>::write(buffer, SNAPSHOT_MAGIC);
+        Serializer<uint64_t>::write(buffer, SNAPSHOT_COUNT_PENDING); // patched below
+        uint64_t count = 0;
+        for (const auto& [key, policyWeight] : order) {
+            V* value = storage->find(key);
+            if (!value || (wheel && wheel->isExpired(key, now))) {
+                continue;
+            }
+            Serializer<uint32_t>::write(buffer, policyWeight);
+            KeySerializer::write(buffer, key);
+            ValueSerializer::write(buffer, *value);
+            ++count;
+            if (buffer.size() >= (1 << 20)) {
+                out.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+        out.write(buffer.data(), buffer.size());
+        out.seekp(sizeof(uint32_t));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        out.close();
+        if (!out) {
+            error_code ignored;
+            filesystem::remove(tmpPath, ignored);
+            throw runtime_error("Failed writing snapshot: " + tmpPath);
+        }
+        replaceWithSnapshot(tmpPath, path);
+    }
+
+    // Rebuild from a snapshot in one linear pass over the mmapped file.
+    // Entries are replayed coldest first, so if the snapshot is larger than
+    // this cache the coldest ones are the ones evicted. Returns entries read.
+    template <typename KeySerializer = Serializer<K>, typename ValueSerializer = Serializer<V>>
+    size_t restore(const string& path) {
+        MappedFile file(path);
+        const char* in = file.begin();
+        const char* end = file.end();
+        if (end - in < static_cast<ptrdiff_t>(SNAPSHOT_HEADER_BYTES)) {
+            throw runtime_error("Incomplete snapshot header: " + path);
+        }
+        if (Serializer<uint32_t>::read(in, end) != SNAPSHOT_MAGIC) {
+            throw runtime_error("Not a cache snapshot: " + path);
+        }
+        uint64_t count = Serializer<uint64_t>::read(in, end);
+        if (count == SNAPSHOT_COUNT_PENDING) {
+            throw runtime_error("Incomplete snapshot header: " + path);
+        }
+        for (uint64_t i = 0; i < count; ++i) {
+            uint32_t policyWeight = Serializer<uint32_t>::read(in, end);
+            K key = KeySerializer::read(in, end);
+            V value = ValueSerializer::read(in, end);
+            size_t weight = weightOf(key, value);
+            if (storage->find(key) || !makeRoomFor(weight)) {
+                continue; // live entries win over snapshot ones
+            }
+            timedPolicy([&] { policy->restoreKey(key, policyWeight); });
+            storage->add(key, value);
+            totalWeight += weight;
+            scheduleExpiry(key, 0);
+        }
+        return count;
+    }
+
+    // Maintenance tick: drop every entry whose deadline has passed.
+    // Returns the number of expired entries.
+    size_t cleanUp() {
+        if (!wheel) {
+            return 0;
+        }
+        vector<K> expired = wheel->advance(clock());
+        for (const K& key : expired) {
+            expire(key);
+        }
+        return expired.size();
+    }
+
+    // Sum of entry weights; equals entryCount() without a weigher
+    size_t bytesUsed() const {
+        return totalWeight;
+    }
+
+    size_t entryCount() const {
+        return storage->size();
+    }
+};
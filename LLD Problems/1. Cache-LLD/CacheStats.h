@@ -0,0 +1,91 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+using namespace std;
+
+// Point-in-time totals read from CacheStats
+struct CacheStatsSnapshot {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t loads = 0;
+    uint64_t loadFailures = 0;
+    uint64_t loadNanos = 0;
+    uint64_t policyNanos = 0; // time spent inside EvictionPolicy calls
+
+    double hitRatio() const {
+        uint64_t requests = hits + misses;
+        return requests == 0 ? 1.0 : static_cast<double>(hits) / requests;
+    }
+};
+
+// Cache statistics
+// Counters are striped: each thread bumps its own cache-line-sized stripe
+// with relaxed atomics, so recording never contends across threads.
+// snapshot() sums the stripes, so reads are the (rare) slow path.
+class CacheStats {
+public:
+    enum Counter { Hits, Misses, Evictions, Loads, LoadFailures, LoadNanos, PolicyNanos, CounterCount };
+
+private:
+    static constexpr size_t STRIPES = 16;
+
+    struct alignas(64) Stripe {
+        array<atomic<uint64_t>, CounterCount> counters{};
+    };
+
+    array<Stripe, STRIPES> stripes;
+
+    static size_t stripeIndex() {
+        static thread_local size_t index = hash<thread::id>()(this_thread::get_id()) % STRIPES;
+        return index;
+    }
+
+public:
+    void record(Counter counter, uint64_t amount = 1) {
+        stripes[stripeIndex()].counters[counter].fetch_add(amount, memory_order_relaxed);
+    }
+
+    CacheStatsSnapshot snapshot() const {
+        array<uint64_t, CounterCount> totals{};
+        for (const auto& stripe : stripes) {
+            for (size_t i = 0; i < CounterCount; ++i) {
+                totals[i] += stripe.counters[i].load(memory_order_relaxed);
+            }
+        }
+        CacheStatsSnapshot s;
+        s.hits = totals[Hits];
+        s.misses = totals[Misses];
+        s.evictions = totals[Evictions];
+        s.loads = totals[Loads];
+        s.loadFailures = totals[LoadFailures];
+        s.loadNanos = totals[LoadNanos];
+        s.policyNanos = totals[PolicyNanos];
+        return s;
+    }
+};
+
+// Adds the scope's elapsed time to a CacheStats counter; does nothing (and
+// reads no clock) when stats are disabled
+class ScopedStatsTimer {
+    CacheStats* stats;
+    CacheStats::Counter counter;
+    chrono::steady_clock::time_point start;
+
+public:
+    ScopedStatsTimer(CacheStats* stats_, CacheStats::Counter counter_)
+        : stats(stats_), counter(counter_) {
+        if (stats) start = chrono::steady_clock::now();
+    }
+
+    ~ScopedStatsTimer() {
+        if (stats) {
+            stats->record(counter, chrono::duration_cast<chrono::nanoseconds>(
+                chrono::steady_clock::now() - start).count());
+        }
+    }
+};
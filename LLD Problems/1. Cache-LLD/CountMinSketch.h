@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+using namespace std;
+
+// 4-bit Count-Min Sketch with periodic halving (aging)
+// Sixteen 4-bit counters are packed per 64-bit word and every key touches
+// four of them. Once sampleSize increments have been recorded all counters
+// are halved, so keys that were hot long ago gradually lose their weight.
+template <typename K>
+class CountMinSketch {
+    static constexpr uint64_t SEEDS[4] = {
+        0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL,
+        0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL};
+    static constexpr uint64_t RESET_MASK = 0x7777777777777777ULL;
+
+    vector<uint64_t> table;
+    size_t mask = 0;
+    size_t additions = 0;
+    size_t sampleSize = 0;
+    hash<K> hasher;
+
+    static uint64_t mix(uint64_t h, uint64_t seed) {
+        h = (h + seed) * 0x9E3779B97F4A7C15ULL;
+        return h ^ (h >> 32);
+    }
+
+    void reset() {
+        for (auto& word : table) {
+            word = (word >> 1) & RESET_MASK;
+        }
+        additions /= 2;
+    }
+
+public:
+    // expectedKeys is normally the cache's maximum size
+    explicit CountMinSketch(size_t expectedKeys) {
+        size_t width = 16;
+        while (width < expectedKeys) {
+            width *= 2;
+        }
+        table.assign(width, 0);
+        mask = width - 1;
+        sampleSize = 10 * (expectedKeys == 0 ? 1 : expectedKeys);
+    }
+
+    int frequency(const K& key) const {
+        uint64_t h = hasher(key);
+        int freq = 15;
+        for (int i = 0; i < 4; ++i) {
+            uint64_t x = mix(h, SEEDS[i]);
+            int shift = static_cast<int>((x >> 60) << 2);
+            freq = min(freq, static_cast<int>((table[x & mask] >> shift) & 0xF));
+        }
+        return freq;
+    }
+
+    void increment(const K& key) {
+        uint64_t h = hasher(key);
+        bool added = false;
+        for (int i = 0; i < 4; ++i) {
+            uint64_t x = mix(h, SEEDS[i]);
+            int shift = static_cast<int>((x >> 60) << 2);
+            uint64_t& word = table[x & mask];
+            if (((word >> shift) & 0xF) < 15) {
+                word += 1ULL << shift;
+                added = true;
+            }
+        }
+        if (added && ++additions >= sampleSize) {
+            reset();
+        }
+    }
+};
@@ -0,0 +1,217 @@
+#pragma once
+#include "Storage.h"
+#include "Snapshot.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+using namespace std;
+
+// Disk Storage (append-only segment files + in-memory index)
+// Every add() appends a key/value record to the active segment file and
+// points the index at it; overwrites and removes only leave dead bytes
+// behind. The active segment rolls over at segmentBytes, and once more than
+// half of the bytes on disk are dead, compact() rewrites the live records of
+// sealed segments into the active one and deletes the old files.
+// The index lives in memory, so segment files are scratch space: they are
+// cleared when the storage is opened and closed. Typically used as Cache's spill tier.
+template <typename K, typename V,
+          typename KeySerializer = Serializer<K>, typename ValueSerializer = Serializer<V>>
+class DiskStorage : public Storage<K, V> {
+    struct Location {
+        uint32_t segment;
+        uint64_t offset;
+        uint32_t length;
+    };
+
+    struct Segment {
+        unique_ptr<fstream> file;
+        uint64_t totalBytes = 0;
+        uint64_t liveBytes = 0;
+    };
+
+    filesystem::path directory;
+    uint64_t segmentBytes;
+    unordered_map<K, Location> index;
+    map<uint32_t, Segment> segments;
+    uint32_t activeSegment = 0;
+    uint64_t totalBytes = 0;
+    uint64_t liveBytes = 0;
+    V lastRead{}; // backs the pointer returned by find()
+
+    filesystem::path segmentPath(uint32_t id) const {
+        return directory / ("segment-" + to_string(id) + ".log");
+    }
+
+    void openSegment(uint32_t id) {
+        Segment segment;
+        segment.file = make_unique<fstream>(segmentPath(id), ios::binary | ios::in | ios::out | ios::trunc);
+        if (!*segment.file) {
+            throw runtime_error("Cannot create segment: " + segmentPath(id).string());
+        }
+        segments[id] = std::move(segment);
+        activeSegment = id;
+    }
+
+    Location append(const string& record) {
+        Segment* segment = &segments[activeSegment];
+        if (segment->totalBytes > 0 && segment->totalBytes + record.size() > segmentBytes) {
+            openSegment(activeSegment + 1);
+            segment = &segments[activeSegment];
+        }
+        Location location{activeSegment, segment->totalBytes, static_cast<uint32_t>(record.size())};
+        segment->file->seekp(static_cast<streamoff>(location.offset));
+        segment->file->write(record.data(), record.size());
+        segment->totalBytes += record.size();
+        segment->liveBytes += record.size();
+        totalBytes += record.size();
+        liveBytes += record.size();
+        return location;
+    }
+
+    string readRecord(const Location& location) {
+        fstream& file = *segments.at(location.segment).file;
+        file.flush();
+        file.seekg(static_cast<streamoff>(location.offset));
+        string record(location.length, '\0');
+        file.read(record.data(), location.length);
+        if (!file) {
+            throw runtime_error("Failed reading segment " + to_string(location.segment));
+        }
+        return record;
+    }
+
+    V decodeValue(const string& record) {
+        const char* in = record.data();
+        const char* end = in + record.size();
+        KeySerializer::read(in, end);
+        return ValueSerializer::read(in, end);
+    }
+
+    void markDead(const Location& location) {
+        segments[location.segment].liveBytes -= location.length;
+        liveBytes -= location.length;
+    }
+
+    void compactIfNeeded() {
+        if (segments.size() > 1 && liveBytes * 2 < totalBytes) {
+            compact();
+        }
+    }
+
+public:
+    explicit DiskStorage(const string& dir, uint64_t segmentBytes_ = 64ULL << 20)
+        : directory(dir), segmentBytes(segmentBytes_) {
+        filesystem::create_directories(directory);
+        for (const auto& entry : filesystem::directory_iterator(directory)) {
+            if (entry.path().filename().string().rfind("segment-", 0) == 0) {
+                filesystem::remove(entry.path());
+            }
+        }
+        openSegment(0);
+    }
+
+    ~DiskStorage() {
+        segments.clear();
+        for (const auto& entry : filesystem::directory_iterator(directory)) {
+            if (entry.path().filename().string().rfind("segment-", 0) == 0) {
+                filesystem::remove(entry.path());
+            }
+        }
+        error_code ignored;
+        filesystem::remove(directory, ignored); // only succeeds if now empty
+    }
+
+    void add(const K& key, const V& value) override {
+        string record;
+        KeySerializer::write(record, key);
+        ValueSerializer::write(record, value);
+        Location location = append(record);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            markDead(it->second);
+            it->second = location;
+            compactIfNeeded();
+        } else {
+            index.emplace(key, location);
+        }
+    }
+
+    V get(const K& key) override {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            throw out_of_range("Key not found");
+        }
+        return decodeValue(readRecord(it->second));
+    }
+
+    void remove(const K& key) override {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            return;
+        }
+        markDead(it->second);
+        index.erase(it);
+        compactIfNeeded();
+    }
+
+    bool contains(const K& key) override {
+        return index.find(key) != index.end();
+    }
+
+    // The value is decoded into a member, so the pointer is only valid until
+    // the next call on this storage; writes through it are not persisted.
+    V* find(const K& key) override {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            return nullptr;
+        }
+        lastRead = decodeValue(readRecord(it->second));
+        return &lastRead;
+    }
+
+    size_t size() const override {
+        return index.size();
+    }
+
+    // Rewrite live records of sealed segments whose bytes are mostly dead
+    void compact() {
+        vector<uint32_t> victims;
+        for (const auto& [id, segment] : segments) {
+            if (id != activeSegment && segment.liveBytes * 2 < segment.totalBytes) {
+                victims.push_back(id);
+            }
+        }
+        if (victims.empty()) {
+            return;
+        }
+        for (auto& [key, location] : index) {
+            for (uint32_t id : victims) {
+                if (location.segment == id) {
+                    string record = readRecord(location);
+                    markDead(location);
+                    location = append(record);
+                    break;
+                }
+            }
+        }
+        for (uint32_t id : victims) {
+            totalBytes -= segments[id].totalBytes;
+            liveBytes -= segments[id].liveBytes; // 0 after the moves above
+            segments.erase(id);
+            filesystem::remove(segmentPath(id));
+        }
+    }
+
+    uint64_t diskBytes() const {
+        return totalBytes;
+    }
+
+    uint64_t liveDiskBytes() const {
+        return liveBytes;
+    }
+};
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+using namespace std;
+
+// EvictionPolicy Interface
+template <typename K>
+class EvictionPolicy {
+public:
+    virtual void markAccessed(const K& key) = 0;
+    virtual void add(const K& key) = 0;
+    virtual K evict() = 0;
+    virtual void remove(const K& key) = 0; // Key left the cache without being evicted (e.g. expired)
+    // Recency update for a batch of hits, in order; one virtual call per batch
+    virtual void markAccessedAll(span<const K> keys) {
+        for (const K& key : keys) markAccessed(key);
+    }
+    // Snapshot support: keys from coldest (evicted first) to hottest, each with
+    // a policy-specific weight (e.g. LFU frequency). Replaying them in that
+    // order through restoreKey() rebuilds the eviction order.
+    virtual vector<pair<K, uint32_t>> exportOrder() const = 0;
+    virtual void restoreKey(const K& key, uint32_t weight) = 0;
+    // True if markAccessed may run concurrently with other markAccessed calls
+    virtual bool isMarkAccessedThreadSafe() const { return false; }
+    virtual ~EvictionPolicy() = default;
+};
@@ -0,0 +1,221 @@
+#pragma once
+#include "EvictionPolicy.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+// Slab of nodes addressed by 32-bit index; released slots are reused via a
+// free list, so steady-state churn never touches the heap
+template <typename T>
+class NodePool {
+    vector<T> nodes;
+    vector<uint32_t> freeSlots;
+
+public:
+    uint32_t allocate() {
+        if (!freeSlots.empty()) {
+            uint32_t index = freeSlots.back();
+            freeSlots.pop_back();
+            return index;
+        }
+        nodes.emplace_back();
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    void release(uint32_t index) {
+        freeSlots.push_back(index);
+    }
+
+    T& operator[](uint32_t index) { return nodes[index]; }
+    const T& operator[](uint32_t index) const { return nodes[index]; }
+};
+
+// LFU Eviction Policy (O(1), https://leetcode.com/problems/lfu-cache/description/)
+// Frequencies form a doubly linked list of buckets in ascending order, and
+// each bucket holds a doubly linked list of its keys (most recent first).
+// An access moves the key into the next bucket, creating it only if the
+// frequency isn't there yet, and eviction takes the tail of the first
+// bucket, so every operation is one hash lookup plus pointer updates.
+// Nodes live in NodePools and link by index.
+// With decayEvery > 0, every decayEvery accesses halve all frequencies so
+// keys that were hot long ago age out (O(n) per decay; amortized O(1) when
+// decayEvery is at least the cache size).
+template <typename K>
+class LFUEvictionPolicy final : public EvictionPolicy<K> {
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct KeyNode {
+        K key{};
+        uint32_t bucket = NIL;
+        uint32_t prev = NIL;
+        uint32_t next = NIL;
+    };
+
+    struct Bucket {
+        uint32_t freq = 0;
+        uint32_t prev = NIL;
+        uint32_t next = NIL;
+        uint32_t head = NIL; // most recently touched key
+        uint32_t tail = NIL; // eviction candidate
+    };
+
+    NodePool<KeyNode> keyNodes;
+    NodePool<Bucket> buckets;
+    unordered_map<K, uint32_t> keyIndex;
+    uint32_t firstBucket = NIL; // lowest frequency
+    uint32_t lastBucket = NIL;  // highest frequency
+    uint64_t decayEvery;
+    uint64_t accessesSinceDecay = 0;
+
+    uint32_t insertBucketAfter(uint32_t prev, uint32_t freq) {
+        uint32_t b = buckets.allocate();
+        uint32_t next = prev == NIL ? firstBucket : buckets[prev].next;
+        buckets[b] = Bucket{freq, prev, next, NIL, NIL};
+        if (prev == NIL) firstBucket = b; else buckets[prev].next = b;
+        if (next == NIL) lastBucket = b; else buckets[next].prev = b;
+        return b;
+    }
+
+    void unlinkBucket(uint32_t b) {
+        Bucket& bucket = buckets[b];
+        if (bucket.prev == NIL) firstBucket = bucket.next; else buckets[bucket.prev].next = bucket.next;
+        if (bucket.next == NIL) lastBucket = bucket.prev; else buckets[bucket.next].prev = bucket.prev;
+        buckets.release(b);
+    }
+
+    void pushFront(uint32_t b, uint32_t n) {
+        Bucket& bucket = buckets[b];
+        KeyNode& node = keyNodes[n];
+        node.bucket = b;
+        node.prev = NIL;
+        node.next = bucket.head;
+        if (bucket.head == NIL) bucket.tail = n; else keyNodes[bucket.head].prev = n;
+        bucket.head = n;
+    }
+
+    // Detaches the key from its bucket; frees the bucket if it became empty
+    void unlinkKey(uint32_t n) {
+        KeyNode& node = keyNodes[n];
+        Bucket& bucket = buckets[node.bucket];
+        if (node.prev == NIL) bucket.head = node.next; else keyNodes[node.prev].next = node.next;
+        if (node.next == NIL) bucket.tail = node.prev; else keyNodes[node.next].prev = node.prev;
+        if (bucket.head == NIL) {
+            unlinkBucket(node.bucket);
+        }
+    }
+
+public:
+    explicit LFUEvictionPolicy(uint64_t decayEvery_ = 0)
+        : decayEvery(decayEvery_) {}
+
+    void markAccessed(const K& key) override {
+        uint32_t n = keyIndex.at(key);
+        uint32_t b = keyNodes[n].bucket;
+        uint32_t freq = buckets[b].freq;
+        if (freq == UINT32_MAX) {
+            // Saturated: only refresh recency (not the head, so b stays non-empty)
+            if (keyNodes[n].prev != NIL) {
+                unlinkKey(n);
+                pushFront(b, n);
+            }
+        } else {
+            uint32_t next = buckets[b].next;
+            if (next == NIL || buckets[next].freq != freq + 1) {
+                next = insertBucketAfter(b, freq + 1);
+            }
+            unlinkKey(n);
+            pushFront(next, n);
+        }
+
+        if (decayEvery > 0 && ++accessesSinceDecay >= decayEvery) {
+            decay();
+        }
+    }
+
+    void add(const K& key) override {
+        uint32_t b = firstBucket;
+        if (b == NIL || buckets[b].freq != 1) {
+            b = insertBucketAfter(NIL, 1);
+        }
+        uint32_t n = keyNodes.allocate();
+        keyNodes[n].key = key;
+        pushFront(b, n);
+        keyIndex[key] = n;
+    }
+
+    void remove(const K& key) override {
+        auto it = keyIndex.find(key);
+        if (it == keyIndex.end()) {
+            return;
+        }
+        unlinkKey(it->second);
+        keyNodes.release(it->second);
+        keyIndex.erase(it);
+    }
+
+    K evict() override {
+        if (firstBucket == NIL) {
+            throw runtime_error("Cache is empty");
+        }
+        uint32_t n = buckets[firstBucket].tail;
+        K keyToEvict = keyNodes[n].key;
+        unlinkKey(n);
+        keyNodes.release(n);
+        keyIndex.erase(keyToEvict);
+        return keyToEvict;
+    }
+
+    // Halve every frequency (minimum 1). Buckets that land on the same
+    // frequency merge, with the formerly hotter keys in front.
+    void decay() {
+        accessesSinceDecay = 0;
+        for (uint32_t b = firstBucket; b != NIL;) {
+            uint32_t next = buckets[b].next;
+            uint32_t freq = max<uint32_t>(1, buckets[b].freq / 2);
+            uint32_t prev = buckets[b].prev;
+            if (prev != NIL && buckets[prev].freq == freq) {
+                // Splice b's keys in front of prev's
+                Bucket& into = buckets[prev];
+                Bucket& from = buckets[b];
+                for (uint32_t n = from.head; n != NIL; n = keyNodes[n].next) {
+                    keyNodes[n].bucket = prev;
+                }
+                keyNodes[from.tail].next = into.head;
+                keyNodes[into.head].prev = from.tail;
+                into.head = from.head;
+                unlinkBucket(b);
+            } else {
+                buckets[b].freq = freq;
+            }
+            b = next;
+        }
+    }
+
+    vector<pair<K, uint32_t>> exportOrder() const override {
+        vector<pair<K, uint32_t>> order;
+        order.reserve(keyIndex.size());
+        for (uint32_t b = firstBucket; b != NIL; b = buckets[b].next) {
+            for (uint32_t n = buckets[b].tail; n != NIL; n = keyNodes[n].prev) {
+                order.emplace_back(keyNodes[n].key, buckets[b].freq);
+            }
+        }
+        return order;
+    }
+
+    // Restores arrive coldest first, so the bucket is usually the last one
+    void restoreKey(const K& key, uint32_t weight) override {
+        uint32_t freq = max<uint32_t>(1, weight);
+        uint32_t prev = lastBucket;
+        while (prev != NIL && buckets[prev].freq > freq) {
+            prev = buckets[prev].prev;
+        }
+        uint32_t b = (prev != NIL && buckets[prev].freq == freq) ? prev : insertBucketAfter(prev, freq);
+        uint32_t n = keyNodes.allocate();
+        keyNodes[n].key = key;
+        pushFront(b, n);
+        keyIndex[key] = n;
+    }
+};
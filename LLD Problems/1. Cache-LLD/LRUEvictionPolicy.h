@@ -0,0 +1,59 @@
+#pragma once
+#include "EvictionPolicy.h"
+#include <list>
+#include <unordered_map>
+#include <stdexcept>
+#include <vector>
+using namespace std;
+
+// https://leetcode.com/problems/lru-cache/description/
+// LRU Eviction Policy
+template <typename K>
+class LRUEvictionPolicy final : public EvictionPolicy<K> {
+    list<K> accessOrder;
+    unordered_map<K, typename list<K>::iterator> keyIteratorMap;
+
+public:
+    void markAccessed(const K& key) override {
+        if (keyIteratorMap.find(key) != keyIteratorMap.end()) {
+            accessOrder.erase(keyIteratorMap[key]);
+        }
+        add(key);
+    }
+
+    void add(const K& key) override {
+        accessOrder.push_front(key);
+        keyIteratorMap[key] = accessOrder.begin();
+    }
+
+    void remove(const K& key) override {
+        auto it = keyIteratorMap.find(key);
+        if (it != keyIteratorMap.end()) {
+            accessOrder.erase(it->second);
+            keyIteratorMap.erase(it);
+        }
+    }
+
+    vector<pair<K, uint32_t>> exportOrder() const override {
+        vector<pair<K, uint32_t>> order;
+        order.reserve(accessOrder.size());
+        for (auto it = accessOrder.rbegin(); it != accessOrder.rend(); ++it) {
+            order.emplace_back(*it, 0);
+        }
+        return order;
+    }
+
+    void restoreKey(const K& key, uint32_t) override {
+        add(key);
+    }
+
+    K evict() override {
+        if (accessOrder.empty()) {
+            throw runtime_error("Cache is empty");
+        }
+        K keyToEvict = accessOrder.back();
+        accessOrder.pop_back();
+        keyIteratorMap.erase(keyToEvict);
+        return keyToEvict;
+    }
+};
@@ -0,0 +1,248 @@
+#pragma once
+#include "Storage.h"
+#include "EvictionPolicy.h"
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+using namespace std;
+
+template <typename K, typename V>
+class LRUHashPolicy;
+
+// Fused LRU storage + policy
+// Entries live in one open-addressing (linear probing) table and are chained
+// into the recency list through prev/next slot indices, so a hit only splices
+// indices and never allocates. The last probed slot is remembered, which lets
+// Cache's find -> markAccessed sequence cost a single hash lookup.
+// Pair it with LRUHashPolicy instead of MapStorage + LRUEvictionPolicy:
+//   auto* storage = new LRUHashStorage<K, V>(maxSize);
+//   Cache<K, V> cache(storage, storage->newPolicy(), maxSize);
+template <typename K, typename V>
+class LRUHashStorage : public Storage<K, V> {
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct Slot {
+        K key{};
+        V value{};
+        size_t hash = 0;
+        uint32_t prev = NIL;
+        uint32_t next = NIL;
+        bool used = false;
+    };
+
+    vector<Slot> slots;
+    size_t mask = 0;
+    size_t count = 0;
+    uint32_t head = NIL; // most recently used
+    uint32_t tail = NIL; // least recently used
+    uint32_t lastSlot = NIL;
+    hash<K> hasher;
+
+    size_t hashOf(const K& key) const {
+        // std::hash is identity for integers, so spread the bits before masking
+        return static_cast<size_t>(static_cast<uint64_t>(hasher(key)) * 0x9E3779B97F4A7C15ULL >> 16);
+    }
+
+    uint32_t locate(const K& key) {
+        if (lastSlot != NIL && slots[lastSlot].used && slots[lastSlot].key == key) {
+            return lastSlot;
+        }
+        size_t h = hashOf(key);
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            if (!slots[i].used) {
+                return NIL;
+            }
+            if (slots[i].hash == h && slots[i].key == key) {
+                lastSlot = static_cast<uint32_t>(i);
+                return lastSlot;
+            }
+        }
+    }
+
+    void unlink(uint32_t i) {
+        Slot& s = slots[i];
+        if (s.prev != NIL) slots[s.prev].next = s.next; else head = s.next;
+        if (s.next != NIL) slots[s.next].prev = s.prev; else tail = s.prev;
+        s.prev = s.next = NIL;
+    }
+
+    void linkFront(uint32_t i) {
+        slots[i].prev = NIL;
+        slots[i].next = head;
+        if (head != NIL) slots[head].prev = i;
+        head = i;
+        if (tail == NIL) tail = i;
+    }
+
+    uint32_t insertNew(K key, V value, size_t h) {
+        size_t i = h & mask;
+        while (slots[i].used) {
+            i = (i + 1) & mask;
+        }
+        Slot& s = slots[i];
+        s.key = std::move(key);
+        s.value = std::move(value);
+        s.hash = h;
+        s.used = true;
+        linkFront(static_cast<uint32_t>(i));
+        ++count;
+        return static_cast<uint32_t>(i);
+    }
+
+    // Backward-shift deletion: no tombstones, so probe chains stay short
+    void eraseSlot(uint32_t i) {
+        unlink(i);
+        slots[i] = Slot{};
+        --count;
+        lastSlot = NIL;
+
+        size_t hole = i;
+        for (size_t j = (hole + 1) & mask; slots[j].used; j = (j + 1) & mask) {
+            size_t ideal = slots[j].hash & mask;
+            if (((j - ideal) & mask) < ((j - hole) & mask)) {
+                continue; // j is still reachable from its ideal slot
+            }
+            slots[hole] = std::move(slots[j]);
+            Slot& moved = slots[hole];
+            uint32_t to = static_cast<uint32_t>(hole);
+            if (moved.prev != NIL) slots[moved.prev].next = to; else head = to;
+            if (moved.next != NIL) slots[moved.next].prev = to; else tail = to;
+            slots[j] = Slot{};
+            hole = j;
+        }
+    }
+
+    void grow() {
+        vector<Slot> old = std::move(slots);
+        uint32_t oldTail = tail;
+        slots.assign(old.size() * 2, Slot{});
+        mask = slots.size() - 1;
+        head = tail = NIL;
+        count = 0;
+        lastSlot = NIL;
+        // Re-insert from LRU to MRU so the recency order survives
+        for (uint32_t i = oldTail; i != NIL; i = old[i].prev) {
+            insertNew(std::move(old[i].key), std::move(old[i].value), old[i].hash);
+        }
+    }
+
+public:
+    explicit LRUHashStorage(size_t expectedSize = 16) {
+        size_t capacity = 16;
+        while (capacity < expectedSize * 2) {
+            capacity *= 2;
+        }
+        slots.assign(capacity, Slot{});
+        mask = capacity - 1;
+    }
+
+    // Policy view over this table; Cache owns it alongside the storage
+    LRUHashPolicy<K, V>* newPolicy() {
+        return new LRUHashPolicy<K, V>(*this);
+    }
+
+    void add(const K& key, const V& value) override {
+        uint32_t i = locate(key);
+        if (i != NIL) {
+            slots[i].value = value;
+            return;
+        }
+        if ((count + 1) * 2 > slots.size()) {
+            grow();
+        }
+        lastSlot = insertNew(key, value, hashOf(key));
+    }
+
+    V get(const K& key) override {
+        uint32_t i = locate(key);
+        if (i == NIL) {
+            throw out_of_range("Key not found");
+        }
+        return slots[i].value;
+    }
+
+    void remove(const K& key) override {
+        uint32_t i = locate(key);
+        if (i != NIL) {
+            eraseSlot(i);
+        }
+    }
+
+    bool contains(const K& key) override {
+        return locate(key) != NIL;
+    }
+
+    V* find(const K& key) override {
+        uint32_t i = locate(key);
+        return i == NIL ? nullptr : &slots[i].value;
+    }
+
+    size_t size() const override {
+        return count;
+    }
+
+    void prefetch(const K& key) override {
+        __builtin_prefetch(&slots[hashOf(key) & mask]);
+    }
+
+    void moveToFront(const K& key) {
+        uint32_t i = locate(key);
+        if (i == NIL || i == head) {
+            return;
+        }
+        unlink(i);
+        linkFront(i);
+    }
+
+    vector<K> keysLeastRecentFirst() const {
+        vector<K> keys;
+        keys.reserve(count);
+        for (uint32_t i = tail; i != NIL; i = slots[i].prev) {
+            keys.push_back(slots[i].key);
+        }
+        return keys;
+    }
+
+    const K& leastRecentKey() {
+        if (tail == NIL) {
+            throw runtime_error("Cache is empty");
+        }
+        lastSlot = tail; // the following remove() then skips hashing
+        return slots[tail].key;
+    }
+};
+
+// EvictionPolicy view of LRUHashStorage. New keys are linked at the front by
+// storage.add() and unlinked by storage.remove(), so add() and remove() have
+// nothing to do here.
+template <typename K, typename V>
+class LRUHashPolicy : public EvictionPolicy<K> {
+    LRUHashStorage<K, V>& storage;
+
+public:
+    explicit LRUHashPolicy(LRUHashStorage<K, V>& stor) : storage(stor) {}
+
+    void markAccessed(const K& key) override {
+        storage.moveToFront(key);
+    }
+
+    void add(const K&) override {}
+
+    void remove(const K&) override {} // storage.remove() unlinks the slot
+
+    vector<pair<K, uint32_t>> exportOrder() const override {
+        vector<pair<K, uint32_t>> order;
+        for (const K& key : storage.keysLeastRecentFirst()) {
+            order.emplace_back(key, 0);
+        }
+        return order;
+    }
+
+    void restoreKey(const K&, uint32_t) override {} // storage.add() links it at the front
+
+    K evict() override {
+        return storage.leastRecentKey();
+    }
+};
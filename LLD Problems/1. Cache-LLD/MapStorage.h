@@ -0,0 +1,40 @@
+#pragma once
+#include "Storage.h"
+#include <map>
+using namespace std;
+
+// MapStorage Implementation
+template <typename K, typename V>
+class MapStorage final : public Storage<K, V> {
+    map<K, V> data;
+
+public:
+    void add(const K& key, const V& value) override {
+        data[key] = value;
+    }
+
+    V get(const K& key) override {
+        return data.at(key);
+    }
+
+    void remove(const K& key) override {
+        data.erase(key);
+    }
+
+    bool contains(const K& key) override {
+        return data.find(key) != data.end();
+    }
+
+    V* find(const K& key) override {
+        auto it = data.find(key);
+        return it == data.end() ? nullptr : &it->second;
+    }
+
+    bool isFindThreadSafe() const override {
+        return true; // map::find does not mutate the tree
+    }
+
+    size_t size() const {
+        return data.size();
+    }
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+using namespace std;
+
+// Estimated hit ratio of a cache of `size` entries
+struct HitRatioEstimate {
+    size_t size;
+    double hitRatio;
+};
+
+// Online miss ratio curve (SHARDS sampling + reuse distance histogram)
+// A key is sampled when its mixed hash falls under rate * 2^24, so the
+// same keys are always in or out and the sample is a spatial slice of the
+// workload. For sampled accesses the LRU stack distance (distinct sampled
+// keys since the key's previous access) is counted with a Fenwick tree over
+// access times, scaled by 1/rate, and added to a histogram in buckets of
+// referenceSize/32 up to 4x referenceSize. An LRU cache of size C hits
+// exactly the accesses with distance < C, so the histogram gives the whole
+// curve; for other policies it is a sizing guide.
+// A hot key landing in (or missing from) the sample skews the counts, so
+// estimates apply the SHARDS-adj correction: the gap between expected
+// (accesses * rate) and actual sampled accesses is credited to distance 0.
+// Unsampled accesses cost one hash and a compare.
+template <typename K>
+class MissRatioCurve {
+    static constexpr uint64_t HASH_SPACE = 1ULL << 24;
+    static constexpr size_t BUCKETS_PER_SIZE = 32;
+    static constexpr size_t MAX_SIZE_FACTOR = 4;
+
+    uint64_t threshold;
+    double rate;
+    double bucketWidth;
+    vector<uint64_t> histogram;   // last bucket: cold or beyond 4x referenceSize
+    uint64_t sampledAccesses = 0;
+    uint64_t totalAccesses = 0;
+    unordered_map<K, uint32_t> lastAccess; // sampled key -> access time
+    vector<uint32_t> tree;        // Fenwick tree: 1 at each key's last access time
+    uint32_t now = 0;
+    hash<K> hasher;
+
+    // std::hash is the identity for integers, and mix(0) would be 0
+    static uint64_t mix(uint64_t h) {
+        h += 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    void treeAdd(uint32_t time, int delta) {
+        for (size_t i = time + 1; i <= tree.size(); i += i & (~i + 1)) {
+            tree[i - 1] += delta;
+        }
+    }
+
+    // Marks at times [0, time)
+    uint32_t treeCount(uint32_t time) const {
+        uint32_t count = 0;
+        for (size_t i = time; i > 0; i -= i & (~i + 1)) {
+            count += tree[i - 1];
+        }
+        return count;
+    }
+
+    // Out of time slots: renumber live keys 0..n-1 in access order
+    void compactTimes() {
+        vector<pair<uint32_t, K>> order;
+        order.reserve(lastAccess.size());
+        for (const auto& [key, time] : lastAccess) {
+            order.emplace_back(time, key);
+        }
+        sort(order.begin(), order.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        tree.assign(max<size_t>(tree.size(), 2 * order.size()), 0);
+        now = 0;
+        for (const auto& [time, key] : order) {
+            lastAccess[key] = now;
+            treeAdd(now++, 1);
+        }
+    }
+
+public:
+    MissRatioCurve(size_t referenceSize, double sampleRate = 0.01)
+        : threshold(static_cast<uint64_t>(sampleRate * HASH_SPACE)), rate(sampleRate),
+          bucketWidth(max(1.0, static_cast<double>(referenceSize) / BUCKETS_PER_SIZE)),
+          histogram(BUCKETS_PER_SIZE * MAX_SIZE_FACTOR + 1, 0), tree(1024, 0) {
+        if (sampleRate <= 0 || sampleRate > 1) {
+            throw runtime_error("Sample rate must be in (0, 1]");
+        }
+    }
+
+    void recordAccess(const K& key) {
+        ++totalAccesses;
+        if ((mix(hasher(key)) & (HASH_SPACE - 1)) >= threshold) {
+            return;
+        }
+        if (now == tree.size()) {
+            compactTimes();
+        }
+        size_t bucket = histogram.size() - 1;
+        auto it = lastAccess.find(key);
+        if (it != lastAccess.end()) {
+            uint32_t distance = treeCount(now) - treeCount(it->second + 1);
+            bucket = min(bucket, static_cast<size_t>(distance / rate / bucketWidth));
+            treeAdd(it->second, -1);
+            it->second = now;
+        } else {
+            lastAccess.emplace(key, now);
+        }
+        treeAdd(now++, 1);
+        ++histogram[bucket];
+        ++sampledAccesses;
+    }
+
+    // Estimated LRU hit ratio at `size` entries (resolution referenceSize/32)
+    double hitRatioAt(size_t size) const {
+        if (sampledAccesses == 0) {
+            return 0.0;
+        }
+        size_t buckets = min(histogram.size() - 1, static_cast<size_t>(size / bucketWidth));
+        double expected = totalAccesses * rate;
+        double hits = buckets > 0 ? expected - sampledAccesses : 0.0;
+        for (size_t i = 0; i < buckets; ++i) {
+            hits += histogram[i];
+        }
+        return clamp(hits / expected, 0.0, 1.0);
+    }
+
+    vector<HitRatioEstimate> estimate(const vector<size_t>& sizes) const {
+        vector<HitRatioEstimate> result;
+        for (size_t size : sizes) {
+            result.push_back({size, hitRatioAt(size)});
+        }
+        return result;
+    }
+
+    uint64_t sampleCount() const {
+        return sampledAccesses;
+    }
+};
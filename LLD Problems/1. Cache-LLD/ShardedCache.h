@@ -0,0 +1,247 @@
+#pragma once
+#include "Cache.h"
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+using namespace std;
+
+// Sharded Cache (lock striping)
+// Keys are hashed to one of N independent shards. Each shard owns its own
+// Cache (storage + eviction policy) and its own mutex, so threads touching
+// different shards never contend. Capacity is split evenly across shards, so
+// the global limit is approximate: eviction is per-shard.
+// When the shard's policy has a read-only hit path (e.g. SIEVE), gets take
+// the shard lock in shared mode and run in parallel. Expiry makes reads
+// write, so enabling it switches the shards back to exclusive gets.
+// getOrLoad() coalesces concurrent misses: the first thread to miss a key
+// runs the loader and the others wait on its shared future.
+// multiGet()/multiPut() lock each shard once per batch.
+template <typename K, typename V>
+class ShardedCache {
+    // alignas keeps two shard mutexes off the same cache line
+    struct alignas(64) Shard {
+        shared_mutex mtx;
+        unique_ptr<Cache<K, V>> cache;
+        atomic<bool> sharedGets{false}; // changed only under the exclusive lock
+        unordered_map<K, shared_future<V>> inFlight; // loads in progress
+    };
+
+    vector<unique_ptr<Shard>> shards;
+    hash<K> hasher;
+
+    size_t shardIndex(const K& key) const {
+        // std::hash is identity for integers, so mix the bits before picking a shard
+        uint64_t h = static_cast<uint64_t>(hasher(key)) * 0x9E3779B97F4A7C15ULL;
+        return (h >> 32) % shards.size();
+    }
+
+    Shard& shardFor(const K& key) {
+        return *shards[shardIndex(key)];
+    }
+
+    // Caller holds the shard's exclusive lock
+    static void refreshSharedGets(Shard& shard) {
+        shard.sharedGets.store(shard.cache->supportsConcurrentGet(), memory_order_relaxed);
+    }
+
+    // Runs a read under the shared lock if the shard allows it. The flag is
+    // checked again under the lock, since it may flip while we wait.
+    template <typename F>
+    static auto withReadLock(Shard& shard, F read) {
+        if (shard.sharedGets.load(memory_order_relaxed)) {
+            shared_lock<shared_mutex> lock(shard.mtx);
+            if (shard.sharedGets.load(memory_order_relaxed)) {
+                return read();
+            }
+        }
+        unique_lock<shared_mutex> lock(shard.mtx);
+        return read();
+    }
+
+    template <typename F>
+    void forEachShard(F configure) {
+        for (auto& shard : shards) {
+            unique_lock<shared_mutex> lock(shard->mtx);
+            configure(*shard->cache);
+            refreshSharedGets(*shard);
+        }
+    }
+
+public:
+    ShardedCache(size_t shardCount, size_t maxSize,
+                 function<Storage<K, V>*()> storageFactory,
+                 function<EvictionPolicy<K>*()> policyFactory) {
+        if (shardCount == 0) {
+            throw invalid_argument("shardCount must be > 0");
+        }
+        // 0 keeps the unbounded meaning of Cache::maxSize
+        size_t perShard = maxSize == 0 ? 0 : (maxSize + shardCount - 1) / shardCount;
+        for (size_t i = 0; i < shardCount; ++i) {
+            auto shard = make_unique<Shard>();
+            shard->cache = make_unique<Cache<K, V>>(storageFactory(), policyFactory(), perShard);
+            refreshSharedGets(*shard);
+            shards.push_back(std::move(shard));
+        }
+    }
+
+    void put(const K& key, const V& value) {
+        Shard& shard = shardFor(key);
+        unique_lock<shared_mutex> lock(shard.mtx);
+        shard.cache->put(key, value);
+    }
+
+    // Put with a per-entry TTL (see Cache::put)
+    void put(const K& key, const V& value, long long ttlMillis) {
+        Shard& shard = shardFor(key);
+        unique_lock<shared_mutex> lock(shard.mtx);
+        shard.cache->put(key, value, ttlMillis);
+        refreshSharedGets(shard);
+    }
+
+    V get(const K& key) {
+        Shard& shard = shardFor(key);
+        return withReadLock(shard, [&] { return shard.cache->get(key); });
+    }
+
+    // Batch read: keys are grouped by shard so each shard is locked once for
+    // its whole group. Hits come back grouped by shard, not in input order.
+    MultiGetResult<K, V> multiGet(span<const K> keys) {
+        vector<vector<K>> byShard(shards.size());
+        for (const K& key : keys) {
+            byShard[shardIndex(key)].push_back(key);
+        }
+        MultiGetResult<K, V> result;
+        for (size_t i = 0; i < shards.size(); ++i) {
+            if (byShard[i].empty()) {
+                continue;
+            }
+            Shard& shard = *shards[i];
+            MultiGetResult<K, V> part = withReadLock(shard, [&] { return shard.cache->multiGet(byShard[i]); });
+            move(part.hits.begin(), part.hits.end(), back_inserter(result.hits));
+            move(part.missing.begin(), part.missing.end(), back_inserter(result.missing));
+        }
+        return result;
+    }
+
+    void multiPut(span<const pair<K, V>> entries) {
+        vector<vector<pair<K, V>>> byShard(shards.size());
+        for (const auto& entry : entries) {
+            byShard[shardIndex(entry.first)].push_back(entry);
+        }
+        for (size_t i = 0; i < shards.size(); ++i) {
+            if (byShard[i].empty()) {
+                continue;
+            }
+            unique_lock<shared_mutex> lock(shards[i]->mtx);
+            shards[i]->cache->multiPut(byShard[i]);
+        }
+    }
+
+    // Read-through get with single-flight loading. Loader failures reach every
+    // waiter of that load and are not cached, so the next call retries.
+    V getOrLoad(const K& key, const function<V(const K&)>& loader) {
+        Shard& shard = shardFor(key);
+        bool probed = false;
+        if (shard.sharedGets.load(memory_order_relaxed)) {
+            shared_lock<shared_mutex> lock(shard.mtx);
+            if (shard.sharedGets.load(memory_order_relaxed)) {
+                probed = true;
+                if (optional<V> value = shard.cache->getIfPresent(key)) {
+                    return *value;
+                }
+            }
+        }
+
+        promise<V> loadPromise;
+        shared_future<V> pending;
+        bool leader = false;
+        {
+            unique_lock<shared_mutex> lock(shard.mtx);
+            // The shared-lock probe above already counted this miss
+            if (optional<V> value = shard.cache->getIfPresent(key, !probed)) {
+                return *value;
+            }
+            auto it = shard.inFlight.find(key);
+            if (it != shard.inFlight.end()) {
+                pending = it->second;
+            } else {
+                leader = true;
+                pending = loadPromise.get_future().share();
+                shard.inFlight.emplace(key, pending);
+            }
+        }
+        if (!leader) {
+            return pending.get(); // Rethrows the loader's exception
+        }
+
+        try {
+            V value = shard.cache->loadWithStats(key, loader);
+            {
+                unique_lock<shared_mutex> lock(shard.mtx);
+                shard.cache->put(key, value);
+                shard.inFlight.erase(key);
+            }
+            loadPromise.set_value(value);
+            return value;
+        } catch (...) {
+            {
+                unique_lock<shared_mutex> lock(shard.mtx);
+                shard.inFlight.erase(key);
+            }
+            loadPromise.set_exception(current_exception());
+            throw;
+        }
+    }
+
+    // All shards record into one striped CacheStats
+    void enableStats() {
+        auto sink = make_shared<CacheStats>();
+        forEachShard([&](Cache<K, V>& cache) { cache.enableStats(sink); });
+    }
+
+    // Cache-wide TTLs, applied to every shard (see Cache)
+    void expireAfterWrite(long long millis) {
+        forEachShard([&](Cache<K, V>& cache) { cache.expireAfterWrite(millis); });
+    }
+
+    void expireAfterAccess(long long millis) {
+        forEachShard([&](Cache<K, V>& cache) { cache.expireAfterAccess(millis); });
+    }
+
+    // Millisecond clock for expiry, e.g. a fake clock in tests; it must be
+    // safe to call from several threads
+    void setClock(function<long long()> nowMillis) {
+        forEachShard([&](Cache<K, V>& cache) { cache.setClock(nowMillis); });
+    }
+
+    CacheStatsSnapshot statsSnapshot() const {
+        return shards.front()->cache->statsSnapshot();
+    }
+
+    // Maintenance tick for expiring entries, one shard lock at a time
+    size_t cleanUp() {
+        size_t expired = 0;
+        for (auto& shard : shards) {
+            unique_lock<shared_mutex> lock(shard->mtx);
+            expired += shard->cache->cleanUp();
+        }
+        return expired;
+    }
+
+    size_t shardCount() const {
+        return shards.size();
+    }
+};
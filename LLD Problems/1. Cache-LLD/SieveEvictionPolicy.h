@@ -0,0 +1,104 @@
+#pragma once
+#include "EvictionPolicy.h"
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <stdexcept>
+#include <vector>
+using namespace std;
+
+// SIEVE Eviction Policy (https://cachemon.github.io/SIEVE-website/)
+// Keys sit in a FIFO queue in insertion order. A hit only sets the key's
+// visited bit; nothing is relinked. On eviction the hand walks from the
+// oldest key towards newer ones, clearing visited bits, and evicts the first
+// unvisited key. Because markAccessed never changes the structure, hits can
+// run concurrently under a shared lock (see ShardedCache).
+template <typename K>
+class SieveEvictionPolicy final : public EvictionPolicy<K> {
+    struct Node {
+        K key;
+        atomic<bool> visited{false};
+        Node* prev = nullptr; // towards head (newer)
+        Node* next = nullptr; // towards tail (older)
+
+        explicit Node(const K& k) : key(k) {}
+    };
+
+    unordered_map<K, unique_ptr<Node>> nodes;
+    Node* head = nullptr; // newest
+    Node* tail = nullptr; // oldest
+    Node* hand = nullptr;
+
+    void unlink(Node* node) {
+        if (node->prev) node->prev->next = node->next; else head = node->next;
+        if (node->next) node->next->prev = node->prev; else tail = node->prev;
+    }
+
+public:
+    void markAccessed(const K& key) override {
+        auto it = nodes.find(key);
+        if (it != nodes.end()) {
+            it->second->visited.store(true, memory_order_relaxed);
+        }
+    }
+
+    bool isMarkAccessedThreadSafe() const override {
+        return true;
+    }
+
+    void add(const K& key) override {
+        if (nodes.count(key)) {
+            markAccessed(key);
+            return;
+        }
+        auto node = make_unique<Node>(key);
+        node->next = head;
+        if (head) head->prev = node.get();
+        head = node.get();
+        if (!tail) tail = head;
+        nodes.emplace(key, std::move(node));
+    }
+
+    void remove(const K& key) override {
+        auto it = nodes.find(key);
+        if (it == nodes.end()) {
+            return;
+        }
+        Node* node = it->second.get();
+        if (hand == node) {
+            hand = node->prev;
+        }
+        unlink(node);
+        nodes.erase(it);
+    }
+
+    vector<pair<K, uint32_t>> exportOrder() const override {
+        vector<pair<K, uint32_t>> order;
+        order.reserve(nodes.size());
+        for (Node* node = tail; node; node = node->prev) {
+            order.emplace_back(node->key, node->visited.load(memory_order_relaxed) ? 1 : 0);
+        }
+        return order;
+    }
+
+    void restoreKey(const K& key, uint32_t weight) override {
+        add(key);
+        if (weight) markAccessed(key);
+    }
+
+    K evict() override {
+        if (!tail) {
+            throw runtime_error("Cache is empty");
+        }
+        Node* node = hand ? hand : tail;
+        while (node->visited.load(memory_order_relaxed)) {
+            node->visited.store(false, memory_order_relaxed);
+            node = node->prev ? node->prev : tail;
+        }
+        hand = node->prev;
+        unlink(node);
+        K keyToEvict = node->key;
+        nodes.erase(keyToEvict);
+        return keyToEvict;
+    }
+};
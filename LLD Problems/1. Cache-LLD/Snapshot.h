@@ -0,0 +1,157 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#ifdef _WIN32
+#include <iterator>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// Serializer used by Cache::snapshot/restore. Specialize it (or pass your
+// own type with the same two static functions) for other key/value types.
+template <typename T>
+struct Serializer;
+
+// Trivially copyable types (int, double, PODs) are written as raw bytes
+template <typename T>
+    requires is_trivially_copyable_v<T>
+struct Serializer<T> {
+    static void write(string& out, const T& value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static T read(const char*& in, const char* end) {
+        if (end - in < static_cast<ptrdiff_t>(sizeof(T))) {
+            throw runtime_error("Snapshot truncated");
+        }
+        T value;
+        memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return value;
+    }
+};
+
+// Strings are written as a 32-bit length followed by the bytes
+template <>
+struct Serializer<string> {
+    static void write(string& out, const string& value) {
+        Serializer<uint32_t>::write(out, static_cast<uint32_t>(value.size()));
+        out.append(value);
+    }
+
+    static string read(const char*& in, const char* end) {
+        uint32_t length = Serializer<uint32_t>::read(in, end);
+        if (end - in < static_cast<ptrdiff_t>(length)) {
+            throw runtime_error("Snapshot truncated");
+        }
+        string value(in, length);
+        in += length;
+        return value;
+    }
+};
+
+// Snapshot file layout:
+//   magic "CSN1" | uint64 entry count | entries...
+//   entry = uint32 policy weight | key | value
+// Entries are ordered coldest to hottest, so restoring them in file order
+// rebuilds the eviction order. The count is written last; until then it
+// holds SNAPSHOT_COUNT_PENDING, which restore rejects.
+constexpr uint32_t SNAPSHOT_MAGIC = 0x314E5343; // "CSN1" little-endian
+constexpr uint64_t SNAPSHOT_COUNT_PENDING = UINT64_MAX;
+constexpr size_t SNAPSHOT_HEADER_BYTES = sizeof(uint32_t) + sizeof(uint64_t);
+
+// Makes a fully written snapshot durable and swaps it in: fsync the
+// temporary file, rename it over path, then fsync the directory. A crash
+// leaves either the old snapshot or the new one, never a torn file.
+inline void replaceWithSnapshot(const string& tmpPath, const string& path) {
+    error_code error;
+#ifndef _WIN32
+    int fd = open(tmpPath.c_str(), O_WRONLY);
+    if (fd < 0 || fsync(fd) != 0) {
+        if (fd >= 0) close(fd);
+        filesystem::remove(tmpPath, error);
+        throw runtime_error("Cannot sync snapshot: " + tmpPath);
+    }
+    close(fd);
+#endif
+    filesystem::rename(tmpPath, path, error);
+    if (error) {
+        filesystem::remove(tmpPath, error);
+        throw runtime_error("Cannot replace snapshot: " + path);
+    }
+#ifndef _WIN32
+    filesystem::path directory = filesystem::path(path).parent_path();
+    int dirFd = open(directory.empty() ? "." : directory.c_str(), O_RDONLY);
+    if (dirFd >= 0) {
+        fsync(dirFd); // best effort: the rename itself already happened
+        close(dirFd);
+    }
+#endif
+}
+
+// Read-only view of a whole file: mmap on POSIX, a plain read elsewhere
+class MappedFile {
+    const char* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    vector<char> buffer;
+#else
+    void* mapping = nullptr;
+#endif
+
+public:
+    explicit MappedFile(const string& path) {
+#ifdef _WIN32
+        ifstream in(path, ios::binary);
+        if (!in) {
+            throw runtime_error("Cannot open snapshot: " + path);
+        }
+        buffer.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+        bytes = buffer.data();
+        length = buffer.size();
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw runtime_error("Cannot open snapshot: " + path);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            close(fd);
+            throw runtime_error("Cannot stat snapshot: " + path);
+        }
+        length = static_cast<size_t>(info.st_size);
+        if (length > 0) {
+            mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                close(fd);
+                throw runtime_error("Cannot mmap snapshot: " + path);
+            }
+            madvise(mapping, length, MADV_SEQUENTIAL); // one linear pass
+            bytes = static_cast<const char*>(mapping);
+        }
+        close(fd); // the mapping stays valid
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (mapping) munmap(mapping, length);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* begin() const { return bytes; }
+    const char* end() const { return bytes + length; }
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include <concepts>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+using namespace std;
+
+// What StaticCache needs from a storage policy (MapStorage fits)
+template <typename S, typename K, typename V>
+concept CacheStoragePolicy = requires(S storage, const K& key, const V& value) {
+    { storage.find(key) } -> same_as<V*>;
+    storage.add(key, value);
+    storage.remove(key);
+    { storage.size() } -> convertible_to<size_t>;
+};
+
+// What StaticCache needs from an eviction policy (LRU/LFU/TinyLFU/SIEVE fit)
+template <typename P, typename K>
+concept CacheEvictionPolicy = requires(P policy, const K& key) {
+    policy.markAccessed(key);
+    policy.add(key);
+    { policy.evict() } -> convertible_to<K>;
+};
+
+// Compile-time policy-based Cache
+// Same put/get semantics as Cache (count-based capacity), but storage and
+// eviction policy are held by value and chosen as template parameters, so
+// the hit path has no virtual dispatch and can inline into the caller. The
+// existing policies are declared final, which lets the compiler call them
+// directly even though they still implement the virtual interfaces.
+// Use Cache when the policy has to be picked at runtime.
+template <typename K, typename V, typename StoragePolicy, typename EvictionPolicyT>
+    requires CacheStoragePolicy<StoragePolicy, K, V> && CacheEvictionPolicy<EvictionPolicyT, K>
+class StaticCache {
+    StoragePolicy storage;
+    EvictionPolicyT policy;
+    size_t maxSize;
+
+public:
+    explicit StaticCache(size_t size)
+        : maxSize(size) {}
+
+    StaticCache(size_t size, StoragePolicy stor, EvictionPolicyT pol)
+        : storage(std::move(stor)), policy(std::move(pol)), maxSize(size) {}
+
+    void put(const K& key, const V& value) {
+        if (V* existing = storage.find(key)) {
+            policy.markAccessed(key);
+            *existing = value;
+            return;
+        }
+        if (maxSize > 0 && storage.size() >= maxSize) {
+            K evictKey = policy.evict();
+            storage.remove(evictKey);
+        }
+        policy.add(key);
+        storage.add(key, value);
+    }
+
+    optional<V> getIfPresent(const K& key) {
+        V* value = storage.find(key);
+        if (!value) {
+            return nullopt;
+        }
+        policy.markAccessed(key);
+        return *value;
+    }
+
+    V get(const K& key) {
+        V* value = storage.find(key);
+        if (!value) {
+            throw runtime_error("Key not found");
+        }
+        policy.markAccessed(key);
+        return *value;
+    }
+
+    size_t entryCount() const {
+        return storage.size();
+    }
+};
@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef>
+using namespace std;
+
+// Storage Interface
+template <typename K, typename V>
+class Storage {
+public:
+    virtual void add(const K& key, const V& value) = 0;
+    virtual V get(const K& key) = 0;
+    virtual void remove(const K& key) = 0;
+    virtual bool contains(const K& key) = 0;
+    virtual V* find(const K& key) = 0; // nullptr if absent; lets Cache hit with one lookup
+    virtual size_t size() const = 0; // Added for size retrieval
+    // Hint that key is about to be looked up; batch reads call it ahead of find
+    virtual void prefetch(const K&) {}
+    // True if find may run concurrently with other find calls
+    virtual bool isFindThreadSafe() const { return false; }
+    virtual ~Storage() = default;
+};
@@ -0,0 +1,137 @@
+#pragma once
+#include <algorithm>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+// Hierarchical Timing Wheel
+// 4 levels of 64 slots. Level 0 slots are one tick wide, level 1 slots 64
+// ticks, level 2 slots 64^2 ticks and so on (1 ms ticks cover ~4.6 hours;
+// later deadlines are parked in the top level and re-placed on cascade).
+// schedule/cancel are O(1); advance visits each elapsed tick once and moves
+// a higher-level slot down only when level 0 wraps into its range.
+template <typename K>
+class TimingWheel {
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr int SLOTS = 1 << SLOT_BITS;
+    static constexpr long long SLOT_MASK = SLOTS - 1;
+
+    struct Timer {
+        K key;
+        long long deadlineMillis;
+    };
+
+    struct Location {
+        int slot;
+        typename list<Timer>::iterator iter;
+    };
+
+    long long tickMillis;
+    long long currentTick;
+    vector<list<Timer>> slots;
+    unordered_map<K, Location> timers;
+
+    // Pick the slot for a timer relative to currentTick
+    int slotFor(long long tick) const {
+        long long delta = tick - currentTick;
+        for (int level = 0; level < LEVELS; ++level) {
+            if (delta < (1LL << (SLOT_BITS * (level + 1)))) {
+                return level * SLOTS + static_cast<int>((tick >> (SLOT_BITS * level)) & SLOT_MASK);
+            }
+        }
+        // Beyond the wheel's range: park in the furthest top-level slot
+        long long parked = currentTick + (1LL << (SLOT_BITS * LEVELS)) - 1;
+        return (LEVELS - 1) * SLOTS + static_cast<int>((parked >> (SLOT_BITS * (LEVELS - 1))) & SLOT_MASK);
+    }
+
+    void place(list<Timer>& from, typename list<Timer>::iterator it, long long minTick) {
+        long long tick = max(it->deadlineMillis / tickMillis, minTick);
+        int slot = slotFor(tick);
+        slots[slot].splice(slots[slot].end(), from, it);
+        timers[it->key] = Location{slot, it};
+    }
+
+    void cascade(int level) {
+        int slot = level * SLOTS + static_cast<int>((currentTick >> (SLOT_BITS * level)) & SLOT_MASK);
+        list<Timer> pending;
+        pending.splice(pending.end(), slots[slot]);
+        while (!pending.empty()) {
+            place(pending, pending.begin(), currentTick);
+        }
+    }
+
+public:
+    TimingWheel(long long tickMillis_, long long nowMillis)
+        : tickMillis(max(1LL, tickMillis_)), currentTick(nowMillis / tickMillis),
+          slots(LEVELS * SLOTS) {}
+
+    // Schedule (or reschedule) key to expire at deadlineMillis
+    void schedule(const K& key, long long deadlineMillis) {
+        auto it = timers.find(key);
+        list<Timer> pending;
+        if (it != timers.end()) {
+            list<Timer>& from = slots[it->second.slot];
+            pending.splice(pending.end(), from, it->second.iter);
+            pending.front().deadlineMillis = deadlineMillis;
+        } else {
+            pending.push_back(Timer{key, deadlineMillis});
+        }
+        // Already-due timers fire on the next tick
+        place(pending, pending.begin(), currentTick + 1);
+    }
+
+    void cancel(const K& key) {
+        auto it = timers.find(key);
+        if (it == timers.end()) {
+            return;
+        }
+        slots[it->second.slot].erase(it->second.iter);
+        timers.erase(it);
+    }
+
+    bool isExpired(const K& key, long long nowMillis) const {
+        auto it = timers.find(key);
+        return it != timers.end() && it->second.iter->deadlineMillis <= nowMillis;
+    }
+
+    optional<long long> deadlineOf(const K& key) const {
+        auto it = timers.find(key);
+        if (it == timers.end()) {
+            return nullopt;
+        }
+        return it->second.iter->deadlineMillis;
+    }
+
+    // Advance to nowMillis and return the keys whose deadline passed
+    vector<K> advance(long long nowMillis) {
+        vector<K> expired;
+        long long targetTick = nowMillis / tickMillis;
+        while (currentTick < targetTick) {
+            if (timers.empty()) {
+                currentTick = targetTick;
+                break;
+            }
+            ++currentTick;
+            for (int level = 1; level < LEVELS; ++level) {
+                if ((currentTick & ((1LL << (SLOT_BITS * level)) - 1)) != 0) {
+                    break;
+                }
+                cascade(level);
+            }
+            list<Timer>& due = slots[static_cast<int>(currentTick & SLOT_MASK)];
+            for (auto& timer : due) {
+                timers.erase(timer.key);
+                expired.push_back(timer.key);
+            }
+            due.clear();
+        }
+        return expired;
+    }
+
+    size_t size() const {
+        return timers.size();
+    }
+};
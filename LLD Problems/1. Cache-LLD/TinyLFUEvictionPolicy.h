@@ -0,0 +1,152 @@
+#pragma once
+#include "EvictionPolicy.h"
+#include "CountMinSketch.h"
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <stdexcept>
+#include <vector>
+using namespace std;
+
+// W-TinyLFU Eviction Policy
+// New keys enter a small LRU admission window (1% of capacity). Keys pushed
+// out of the window land in the probation segment of a segmented LRU main
+// region; a second hit promotes them to the protected segment (80% of main).
+// When the cache is full, the window's LRU key (candidate) competes with the
+// probation LRU key (victim) and the one with the lower estimated frequency
+// in the aging count-min sketch is evicted. A one-off scan therefore churns
+// through the window without displacing the frequently used keys.
+template <typename K>
+class TinyLFUEvictionPolicy final : public EvictionPolicy<K> {
+    enum class Region { Window, Probation, Protected };
+
+    struct Node {
+        Region region;
+        typename list<K>::iterator iter;
+    };
+
+    list<K> window;
+    list<K> probation;
+    list<K> protectedList;
+    unordered_map<K, Node> keyMeta;
+    CountMinSketch<K> sketch;
+    size_t windowMax;
+    size_t protectedMax;
+
+    list<K>& listFor(Region region) {
+        if (region == Region::Window) return window;
+        if (region == Region::Probation) return probation;
+        return protectedList;
+    }
+
+    // Move a key to the front of another region; splice reuses the list node
+    void moveTo(Node& node, Region to) {
+        list<K>& dest = listFor(to);
+        dest.splice(dest.begin(), listFor(node.region), node.iter);
+        node.region = to;
+    }
+
+    K removeBack(list<K>& from) {
+        K key = from.back();
+        from.pop_back();
+        keyMeta.erase(key);
+        return key;
+    }
+
+    list<K>& mainVictimList() {
+        return probation.empty() ? protectedList : probation;
+    }
+
+public:
+    explicit TinyLFUEvictionPolicy(size_t maximumSize)
+        : sketch(maximumSize) {
+        windowMax = max<size_t>(1, maximumSize / 100);
+        size_t mainMax = maximumSize > windowMax ? maximumSize - windowMax : 1;
+        protectedMax = mainMax * 8 / 10;
+    }
+
+    // Admission decision: may the window candidate evict the main victim?
+    bool admit(const K& candidate, const K& victim) const {
+        return sketch.frequency(candidate) > sketch.frequency(victim);
+    }
+
+    void markAccessed(const K& key) override {
+        auto it = keyMeta.find(key);
+        if (it == keyMeta.end()) {
+            return;
+        }
+        sketch.increment(key);
+        Node& node = it->second;
+        if (node.region == Region::Probation) {
+            moveTo(node, Region::Protected);
+            if (protectedList.size() > protectedMax) {
+                moveTo(keyMeta[protectedList.back()], Region::Probation);
+            }
+        } else {
+            moveTo(node, node.region);
+        }
+    }
+
+    void add(const K& key) override {
+        if (keyMeta.count(key)) {
+            markAccessed(key);
+            return;
+        }
+        sketch.increment(key);
+        window.push_front(key);
+        keyMeta[key] = Node{Region::Window, window.begin()};
+        if (window.size() > windowMax) {
+            moveTo(keyMeta[window.back()], Region::Probation);
+        }
+    }
+
+    void remove(const K& key) override {
+        auto it = keyMeta.find(key);
+        if (it != keyMeta.end()) {
+            listFor(it->second.region).erase(it->second.iter);
+            keyMeta.erase(it);
+        }
+    }
+
+    // Protected membership is not kept: restored keys re-enter via the window,
+    // but their sketch frequencies survive, so admission decisions do too
+    vector<pair<K, uint32_t>> exportOrder() const override {
+        vector<pair<K, uint32_t>> order;
+        order.reserve(keyMeta.size());
+        for (const list<K>* region : {&probation, &window, &protectedList}) {
+            for (auto it = region->rbegin(); it != region->rend(); ++it) {
+                order.emplace_back(*it, static_cast<uint32_t>(sketch.frequency(*it)));
+            }
+        }
+        return order;
+    }
+
+    void restoreKey(const K& key, uint32_t weight) override {
+        add(key); // counts once in the sketch
+        for (uint32_t i = 1; i < weight; ++i) {
+            sketch.increment(key);
+        }
+    }
+
+    K evict() override {
+        if (keyMeta.empty()) {
+            throw runtime_error("Cache is empty");
+        }
+        if (window.empty()) {
+            return removeBack(mainVictimList());
+        }
+        if (probation.empty() && protectedList.empty()) {
+            return removeBack(window);
+        }
+
+        list<K>& victimList = mainVictimList();
+        const K& candidate = window.back();
+        const K& victim = victimList.back();
+        if (admit(candidate, victim)) {
+            K evicted = removeBack(victimList);
+            moveTo(keyMeta[window.back()], Region::Probation);
+            return evicted;
+        }
+        return removeBack(window);
+    }
+};
@@ -1,183 +1,100 @@
 #include <iostream>
-#include <map>
-#include <list>
 #include <memory>
 #include <string>
-#include <unordered_map>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <fstream>
+#include "Cache.h"
+#include "ShardedCache.h"
+#include "MapStorage.h"
+#include "LRUEvictionPolicy.h"
+#include "LFUEvictionPolicy.h"
+#include "LRUHashStorage.h"
+#include "TinyLFUEvictionPolicy.h"
+#include "SieveEvictionPolicy.h"
+#include "StaticCache.h"
+#include "DiskStorage.h"
 using namespace std;
 
-// EvictionPolicy Interface
-template <typename K>
-class EvictionPolicy {
-public:
-    virtual void markAccessed(const K& key) = 0;
-    virtual void add(const K& key) = 0;
-    virtual K evict() = 0;
-    virtual ~EvictionPolicy() = default;
-};
-
-// https://leetcode.com/problems/lru-cache/description/
-// LRU Eviction Policy
-template <typename K>
-class LRUEvictionPolicy : public EvictionPolicy<K> {
-    list<K> accessOrder;
-    unordered_map<K, typename list<K>::iterator> keyIteratorMap;
-
-public:
-    void markAccessed(const K& key) override {
-        if (keyIteratorMap.find(key) != keyIteratorMap.end()) {
-            accessOrder.erase(keyIteratorMap[key]);
-        }
-        add(key);
-    }
+void testLRUCache() {
+    auto mapStorage = make_unique<MapStorage<int, string>>();
+    auto lruPolicy = make_unique<LRUEvictionPolicy<int>>();
+    Cache<int, string> cache(mapStorage.release(), lruPolicy.release(), 3);
 
-    void add(const K& key) override {
-        accessOrder.push_front(key);
-        keyIteratorMap[key] = accessOrder.begin();
-    }
+    cache.put(1, "One");
+    cache.put(2, "Two");
+    cache.put(3, "Three");
 
-    K evict() override {
-        if (accessOrder.empty()) {
-            throw runtime_error("Cache is empty");
-        }
-        K keyToEvict = accessOrder.back();
-        accessOrder.pop_back();
-        keyIteratorMap.erase(keyToEvict);
-        return keyToEvict;
-    }
-};
-
-// https://leetcode.com/problems/lfu-cache/description/)
-template <typename K>
-struct FrequencyNode {
-    int freq;
-    typename list<K>::iterator iter;
-
-    // Default constructor required by unordered_map's operator[]
-    FrequencyNode() : freq(0), iter() {}
-    FrequencyNode(int f, typename list<K>::iterator it) : freq(f), iter(it) {}
-};
-
-// LFU Eviction Policy (simplified)
-template <typename K>
-class LFUEvictionPolicy : public EvictionPolicy<K> {
-    unordered_map<K, FrequencyNode<K>> keyMeta;
-    unordered_map<int, list<K>> freqListMap;
-    int minFreq = 0;
-
-public:
-    void markAccessed(const K& key) override {
-        int freq = keyMeta[key].freq;
-        auto iter = keyMeta[key].iter;
-
-        // Remove from current frequency list
-        freqListMap[freq].erase(iter);
-
-        // Increase frequency
-        freq += 1;
-        freqListMap[freq].push_front(key);
-        keyMeta[key] = FrequencyNode<K>(freq, freqListMap[freq].begin());
-
-        // Update minFreq if needed
-        if (freqListMap[minFreq].empty()) {
-            minFreq++;
-        }
-    }
+    cache.get(1); // Access key 1 to make it most recently used
 
-    void add(const K& key) override {
-        minFreq = 1;
-        freqListMap[1].push_front(key);
-        keyMeta[key] = FrequencyNode<K>(1, freqListMap[1].begin());
-    }
+    cache.put(4, "Four"); // This should evict the least recently used key (2)
 
-    K evict() override {
-        if (freqListMap[minFreq].empty()) {
-            throw runtime_error("Cache is empty");
-        }
-        K keyToEvict = freqListMap[minFreq].back();
-        freqListMap[minFreq].pop_back();
-        keyMeta.erase(keyToEvict);
-        return keyToEvict;
+    try {
+        cout << "LRU Get 2: " << cache.get(2) << endl; // Should throw an error or undefined
+    } catch (...) {
+        cout << "LRU Key 2 was evicted!" << endl;
     }
-};
+}
 
-// Storage Interface
-template <typename K, typename V>
-class Storage {
-public:
-    virtual void add(const K& key, const V& value) = 0;
-    virtual V get(const K& key) = 0;
-    virtual void remove(const K& key) = 0;
-    virtual bool contains(const K& key) = 0;
-    virtual size_t size() const = 0; // Added for size retrieval
-    virtual ~Storage() = default;
-};
+void testLFUCache() {
+    auto mapStorage = make_unique<MapStorage<int, string>>();
+    auto lfuPolicy = make_unique<LFUEvictionPolicy<int>>();
 
-// MapStorage Implementation
-template <typename K, typename V>
-class MapStorage : public Storage<K, V> {
-    map<K, V> data;
+    Cache<int, string> cache(mapStorage.release(), lfuPolicy.release(), 3);
 
-public:
-    void add(const K& key, const V& value) override {
-        data[key] = value;
-    }
+    cache.put(1, "One");
+    cache.put(2, "Two");
+    cache.put(3, "Three");
 
-    V get(const K& key) override {
-        return data.at(key);
-    }
+    cache.get(1); // freq 2
+    cache.get(1); // freq 3
+    cache.get(2); // freq 2
 
-    void remove(const K& key) override {
-        data.erase(key);
-    }
+    cache.put(4, "Four"); // Should evict key 3 (freq 1)
 
-    bool contains(const K& key) override {
-        return data.find(key) != data.end();
+    try {
+        cout << "LFU Get 3: " << cache.get(3) << endl;
+    } catch (...) {
+        cout << "LFU Key 3 was evicted!" << endl;
     }
 
-    size_t size() const {
-        return data.size();
-    }
-};
+    // Halving every 4 accesses lets key 1's old popularity age out
+    Cache<int, string> aging(new MapStorage<int, string>(), new LFUEvictionPolicy<int>(4), 2);
+    aging.put(1, "One");
+    for (int i = 0; i < 8; ++i) aging.get(1);
+    aging.put(2, "Two");
+    for (int i = 0; i < 4; ++i) aging.get(2);
+    aging.put(3, "Three"); // Should evict key 1 despite its higher lifetime count
 
-// Cache Implementation
-template <typename K, typename V>
-class Cache {
-    unique_ptr<Storage<K, V>> storage;
-    unique_ptr<EvictionPolicy<K>> policy;
-    size_t maxSize;
+    cout << "Aging LFU has key 1: " << (aging.getIfPresent(1) ? "yes" : "no") << endl;
+}
 
-public:
-    Cache(Storage<K, V>* stor, EvictionPolicy<K>* pol, size_t size)
-        : storage(stor), policy(pol), maxSize(size) {}
+void testLRUHashCache() {
+    auto* lruStorage = new LRUHashStorage<int, string>(3);
+    Cache<int, string> cache(lruStorage, lruStorage->newPolicy(), 3);
 
-    void put(const K& key, const V& value) {
-        if (storage->contains(key)) {
-            policy->markAccessed(key);
-        } else {
-            if (maxSize > 0 && storage->size() >= maxSize) {
-                K evictKey = policy->evict();
-                storage->remove(evictKey);
-            }
-            policy->add(key);
-        }
-        storage->add(key, value);
-    }
+    cache.put(1, "One");
+    cache.put(2, "Two");
+    cache.put(3, "Three");
 
-    V get(const K& key) {
-        if (!storage->contains(key)) {
-            throw runtime_error("Key not found");
-        }
-        policy->markAccessed(key);
-        return storage->get(key);
-    }
-};
+    cache.get(1); // Splices key 1 to the front, no allocation
 
+    cache.put(4, "Four"); // This should evict the least recently used key (2)
 
-void testLRUCache() {
-    auto mapStorage = make_unique<MapStorage<int, string>>();
-    auto lruPolicy = make_unique<LRUEvictionPolicy<int>>();
-    Cache<int, string> cache(mapStorage.release(), lruPolicy.release(), 3);
+    try {
+        cout << "LRUHash Get 2: " << cache.get(2) << endl;
+    } catch (...) {
+        cout << "LRUHash Key 2 was evicted!" << endl;
+    }
+}
+
+void testStaticCache() {
+    // Policies are template parameters: no virtual calls on the hit path
+    StaticCache<int, string, MapStorage<int, string>, LRUEvictionPolicy<int>> cache(3);
 
     cache.put(1, "One");
     cache.put(2, "Two");
@@ -188,38 +105,337 @@ void testLRUCache() {
     cache.put(4, "Four"); // This should evict the least recently used key (2)
 
     try {
-        cout << "LRU Get 2: " << cache.get(2) << endl; // Should throw an error or undefined
+        cout << "Static Get 2: " << cache.get(2) << endl;
     } catch (...) {
-        cout << "LRU Key 2 was evicted!" << endl;
+        cout << "Static Key 2 was evicted!" << endl;
     }
 }
 
-void testLFUCache() {
-    auto mapStorage = make_unique<MapStorage<int, string>>();
-    auto lfuPolicy = make_unique<LFUEvictionPolicy<int>>();
+void testSnapshotRestore() {
+    const string path = "cache_snapshot.bin";
+    {
+        Cache<int, string> cache(new MapStorage<int, string>(), new LFUEvictionPolicy<int>(), 3);
+        cache.put(1, "One");
+        cache.put(2, "Two");
+        cache.put(3, "Three");
+        cache.get(1); // freq 2
+        cache.get(1); // freq 3
+        cache.get(2); // freq 2
+        cache.snapshot(path);
+    }
 
-    Cache<int, string> cache(mapStorage.release(), lfuPolicy.release(), 3);
+    // Simulated restart: frequencies come back with the entries
+    Cache<int, string> restored(new MapStorage<int, string>(), new LFUEvictionPolicy<int>(), 3);
+    size_t count = restored.restore(path);
+    restored.put(4, "Four"); // Should still evict key 3 (freq 1)
+    cout << "Restored " << count << " entries, Get 1: " << restored.get(1) << endl;
+    try {
+        restored.get(3);
+    } catch (...) {
+        cout << "Restored Key 3 was evicted!" << endl;
+    }
+
+    // A file cut off inside its header is rejected, not read as empty
+    ofstream(path, ios::binary) << "CSN1ab";
+    try {
+        restored.restore(path);
+    } catch (const exception& e) {
+        cout << e.what() << endl;
+    }
+    remove(path.c_str());
+}
+
+void testTwoTierCache() {
+    Cache<int, string> cache(new MapStorage<int, string>(), new LRUEvictionPolicy<int>(), 2);
+    cache.spillTo(new DiskStorage<int, string>("cache_spill"));
 
     cache.put(1, "One");
     cache.put(2, "Two");
+    cache.put(3, "Three"); // Key 1 spills to disk instead of disappearing
+    cout << "Two-tier memory: " << cache.entryCount() << ", disk: " << cache.spilledCount() << endl;
+    cout << "Two-tier Get 1: " << cache.get(1) << endl; // Promoted back, key 2 spills
+    cout << "Two-tier memory: " << cache.entryCount() << ", disk: " << cache.spilledCount() << endl;
+
+    // Spilled entries keep their deadline; expired victims are not spilled
+    long long now = 0;
+    Cache<int, string> timed(new MapStorage<int, string>(), new LRUEvictionPolicy<int>(), 2);
+    timed.spillTo(new DiskStorage<int, string>("cache_spill_ttl"));
+    timed.setClock([&now] { return now; });
+    timed.expireAfterWrite(1000);
+    timed.put(1, "One");
+    timed.put(2, "Two");
+    now = 900;
+    timed.put(3, "Three"); // Key 1 spills, still due at 1000
+    now = 1100;
+    cout << "Two-tier TTL Get 1: " << (timed.getIfPresent(1) ? "hit" : "expired on disk");
+    timed.put(4, "Four"); // Key 2 has expired, so it is dropped
+    cout << ", disk: " << timed.spilledCount();
+    timed.put(5, "Five"); // Key 3 spills, due at 1900
+    cout << ", Get 3: " << timed.get(3);
+    now = 2000;
+    cout << ", at 2000: " << (timed.getIfPresent(3) ? "hit" : "expired") << endl;
+}
+
+void testMissRatioCurve() {
+    Cache<int, string> cache(new MapStorage<int, string>(), new LRUEvictionPolicy<int>(), 100);
+    cache.enableMissRatioCurve(1.0); // sample every key so the curve is exact
+
+    // Loop over 150 keys: LRU thrashes below 150 entries and hits every repeat above
+    for (int round = 0; round < 10; ++round) {
+        for (int key = 0; key < 150; ++key) {
+            if (!cache.getIfPresent(key)) cache.put(key, to_string(key));
+        }
+    }
+    for (const auto& estimate : cache.estimateHitRatios()) {
+        cout << "Estimated hit ratio at " << estimate.size << " entries: " << estimate.hitRatio << endl;
+    }
+}
+
+void testWeightedCache() {
+    // Budget of 100 bytes, weighted by key + value size
+    Cache<int, string> cache(new MapStorage<int, string>(), new LRUEvictionPolicy<int>(), 100,
+        [](const int&, const string& value) { return sizeof(int) + value.size(); });
+
+    cache.put(1, string(40, 'a'));
+    cache.put(2, string(40, 'b'));
+    cout << "Weighted bytes: " << cache.bytesUsed() << ", entries: " << cache.entryCount() << endl;
+
+    cache.put(3, string(60, 'c')); // Needs 64 bytes: evicts both 1 and 2
+    cout << "Weighted bytes: " << cache.bytesUsed() << ", entries: " << cache.entryCount() << endl;
+
+    cache.put(4, string(200, 'd')); // Larger than the whole budget, not cached
+    try {
+        cache.get(4);
+    } catch (...) {
+        cout << "Weighted Key 4 was too large to cache!" << endl;
+    }
+
+    cache.put(3, string(200, 'e')); // Overwrite that no longer fits: dropped the same way
+    cout << "Weighted has key 3 after oversize overwrite: " << (cache.getIfPresent(3) ? "yes" : "no")
+         << ", bytes: " << cache.bytesUsed() << endl;
+}
+
+void testExpiringCache() {
+    long long now = 0; // Fake clock, so no sleeping
+    Cache<int, string> cache(new MapStorage<int, string>(), new LRUEvictionPolicy<int>(), 10);
+    cache.setClock([&now] { return now; });
+    cache.expireAfterWrite(1000);
+
+    cache.put(1, "One");
+    cache.put(2, "Two", 5000); // Per-entry TTL
     cache.put(3, "Three");
 
-    cache.get(1); // freq 2
-    cache.get(1); // freq 3
-    cache.get(2); // freq 2
+    now = 500;
+    cache.get(3);
+    now = 1200;
+    try {
+        cache.get(1); // Expired lazily on access
+    } catch (...) {
+        cout << "TTL Key 1 expired!" << endl;
+    }
+    cout << "TTL cleanUp removed " << cache.cleanUp() << " entries, "
+         << cache.entryCount() << " left" << endl; // Key 3 expired too, key 2 remains
+    cout << "TTL Get 2: " << cache.get(2) << endl;
+
+    // Write and access TTLs together: reads keep an entry alive only until
+    // its write deadline
+    now = 0;
+    Cache<int, string> both(new MapStorage<int, string>(), new LRUEvictionPolicy<int>(), 10);
+    both.setClock([&now] { return now; });
+    both.expireAfterWrite(1000);
+    both.expireAfterAccess(500);
+    both.put(1, "One");
+    both.put(2, "Two", 10000); // Per-entry write TTL, still subject to the access TTL
+    bool key1At800 = false;
+    bool key1At1200 = false;
+    for (int step = 1; step <= 10; ++step) { // Reads every 400 ms, inside the access TTL
+        now = step * 400;
+        bool live = both.getIfPresent(1).has_value();
+        if (now == 800) key1At800 = live;
+        if (now == 1200) key1At1200 = live;
+        both.getIfPresent(2);
+    }
+    cout << "Write+access TTL: key 1 live at 800: " << (key1At800 ? "yes" : "no")
+         << ", at 1200: " << (key1At1200 ? "yes" : "no") << endl; // Write deadline 1000 wins
+    cout << "Write+access TTL: key 2 live at 4000: " << (both.getIfPresent(2) ? "yes" : "no");
+    now = 4600;
+    cout << ", after 600 ms idle: " << (both.getIfPresent(2) ? "yes" : "no") << endl;
+}
 
-    cache.put(4, "Four"); // Should evict key 3 (freq 1)
+// Read-through replay: a miss puts the key, so hits / trace size is the hit ratio
+double measureHitRatio(EvictionPolicy<int>* policy, size_t maxSize, const vector<int>& trace) {
+    Cache<int, int> cache(new MapStorage<int, int>(), policy, maxSize);
+    size_t hits = 0;
+    for (int key : trace) {
+        try {
+            cache.get(key);
+            ++hits;
+        } catch (...) {
+            cache.put(key, key);
+        }
+    }
+    return static_cast<double>(hits) / trace.size();
+}
+
+// Skewed traffic over 1000 hot keys, interrupted by one-off scans and a
+// popularity shift half way through
+vector<int> makeSkewedTraceWithScans() {
+    mt19937 rng(42);
+    vector<int> trace;
+    int scanKey = 1000000;
+    for (int phase = 0; phase < 20; ++phase) {
+        int offset = phase < 10 ? 0 : 5000; // hot set moves in the second half
+        for (int i = 0; i < 5000; ++i) {
+            // Cubing a uniform draw skews towards low ranks
+            double u = uniform_real_distribution<double>(0.0, 1.0)(rng);
+            trace.push_back(offset + static_cast<int>(u * u * u * 1000));
+        }
+        for (int i = 0; i < 300; ++i) {
+            trace.push_back(scanKey++);
+        }
+    }
+    return trace;
+}
+
+void testHitRatios() {
+    const size_t maxSize = 200;
+    vector<int> trace = makeSkewedTraceWithScans();
+    cout << "Hit ratio LRU:     " << measureHitRatio(new LRUEvictionPolicy<int>(), maxSize, trace) << endl;
+    cout << "Hit ratio LFU:     " << measureHitRatio(new LFUEvictionPolicy<int>(), maxSize, trace) << endl;
+    cout << "Hit ratio TinyLFU: " << measureHitRatio(new TinyLFUEvictionPolicy<int>(maxSize), maxSize, trace) << endl;
+    cout << "Hit ratio SIEVE:   " << measureHitRatio(new SieveEvictionPolicy<int>(), maxSize, trace) << endl;
+}
+
+void testShardedCache() {
+    ShardedCache<int, string> cache(4, 8,
+        [] { return new MapStorage<int, string>(); },
+        [] { return new LRUEvictionPolicy<int>(); });
+
+    vector<thread> writers;
+    for (int t = 0; t < 4; ++t) {
+        writers.emplace_back([&cache, t] {
+            for (int i = 0; i < 100; ++i) {
+                cache.put(t * 100 + i, "v" + to_string(t * 100 + i));
+            }
+        });
+    }
+    for (auto& w : writers) w.join();
 
+    cache.put(7, "Seven");
+    cout << "Sharded Get 7: " << cache.get(7) << endl;
     try {
-        cout << "LFU Get 3: " << cache.get(3) << endl;
+        cache.get(0); // Long gone: each shard keeps only 2 entries
     } catch (...) {
-        cout << "LFU Key 3 was evicted!" << endl;
+        cout << "Sharded Key 0 was evicted!" << endl;
+    }
+
+    // TTLs on a sharded cache whose SIEVE gets would otherwise share the lock
+    atomic<long long> now{0};
+    ShardedCache<int, string> expiring(4, 100,
+        [] { return new MapStorage<int, string>(); },
+        [] { return new SieveEvictionPolicy<int>(); });
+    expiring.setClock([&now] { return now.load(); });
+    expiring.expireAfterWrite(1000);
+    for (int i = 0; i < 10; ++i) {
+        expiring.put(i, "v" + to_string(i));
+    }
+    expiring.put(10, "Ten", 5000); // Per-entry TTL
+    now = 1500;
+    cout << "Sharded TTL cleanUp removed " << expiring.cleanUp() << " entries, Get 10: "
+         << expiring.get(10) << endl;
+}
+
+void testSingleFlightLoad() {
+    ShardedCache<int, string> cache(4, 100,
+        [] { return new MapStorage<int, string>(); },
+        [] { return new LRUEvictionPolicy<int>(); });
+    cache.enableStats();
+    atomic<int> loaderCalls{0};
+    auto slowLoader = [&loaderCalls](const int& key) {
+        ++loaderCalls;
+        this_thread::sleep_for(chrono::milliseconds(50));
+        return "loaded-" + to_string(key);
+    };
+
+    vector<thread> readers;
+    for (int t = 0; t < 16; ++t) {
+        readers.emplace_back([&] { cache.getOrLoad(42, slowLoader); });
+    }
+    for (auto& r : readers) r.join();
+    cout << "Single-flight Get 42: " << cache.get(42) << ", loader calls: " << loaderCalls << endl;
+
+    // A failed load reaches every waiter and is not cached
+    auto failingLoader = [](const int&) -> string {
+        this_thread::sleep_for(chrono::milliseconds(50));
+        throw runtime_error("backend down");
+    };
+    atomic<int> failures{0};
+    readers.clear();
+    for (int t = 0; t < 4; ++t) {
+        readers.emplace_back([&] {
+            try {
+                cache.getOrLoad(7, failingLoader);
+            } catch (const exception&) {
+                ++failures;
+            }
+        });
+    }
+    for (auto& r : readers) r.join();
+    cout << "Single-flight failures seen: " << failures
+         << ", retry: " << cache.getOrLoad(7, slowLoader) << endl;
+
+    CacheStatsSnapshot stats = cache.statsSnapshot();
+    cout << "Stats hits: " << stats.hits << ", misses: " << stats.misses
+         << ", loads: " << stats.loads << ", load failures: " << stats.loadFailures << endl;
+}
+
+void testMultiGet() {
+    ShardedCache<int, string> cache(4, 100,
+        [] { return new MapStorage<int, string>(); },
+        [] { return new LRUEvictionPolicy<int>(); });
+    vector<pair<int, string>> entries = {{1, "One"}, {2, "Two"}, {3, "Three"}, {5, "Five"}};
+    cache.multiPut(entries);
+
+    vector<int> keys = {1, 2, 3, 4, 5, 6};
+    MultiGetResult<int, string> result = cache.multiGet(keys);
+    cout << "MultiGet hits: " << result.hits.size() << ", missing:";
+    for (int key : result.missing) {
+        cout << " " << key;
+    }
+    cout << endl;
+
+    // Mixed batch: keys 3 and 4 are in memory, 1 and 2 on disk. Promoting
+    // 1 and 2 evicts 3 and 4 after their hits were recorded.
+    Cache<int, string> twoTier(new MapStorage<int, string>(), new LRUEvictionPolicy<int>(), 2);
+    twoTier.spillTo(new DiskStorage<int, string>("cache_spill_multiget"));
+    for (int key = 1; key <= 4; ++key) {
+        twoTier.put(key, "v" + to_string(key));
     }
+    vector<int> mixed = {3, 4, 1, 2, 9};
+    result = twoTier.multiGet(mixed);
+    cout << "MultiGet two-tier hits: " << result.hits.size() << ", missing: " << result.missing.size()
+         << ", memory: " << twoTier.entryCount() << ", disk: " << twoTier.spilledCount() << endl;
+
+    // Key 3 is on disk now; asking for it twice hits twice
+    vector<int> repeated = {3, 3};
+    result = twoTier.multiGet(repeated);
+    cout << "MultiGet repeated spilled key hits: " << result.hits.size() << ", missing: " << result.missing.size() << endl;
 }
 
 int main() {
     testLRUCache();
     testLFUCache();
+    testLRUHashCache();
+    testStaticCache();
+    testSnapshotRestore();
+    testTwoTierCache();
+    testMissRatioCurve();
+    testWeightedCache();
+    testExpiringCache();
+    testHitRatios();
+    testShardedCache();
+    testSingleFlightLoad();
+    testMultiGet();
 
     return 0;
 }
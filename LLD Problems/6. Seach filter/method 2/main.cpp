@@ -6,6 +6,9 @@
 #include <memory>
 #include <stdexcept>
 #include <limits>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
 using namespace std;
 
 // Forward declare FilterValue for recursive use
@@ -40,6 +43,96 @@ struct Product {
     string category;
 };
 
+// Compiled filter: a postfix program over a small stack of booleans
+// Leaf ops (category, price range) push whether the product matches, with
+// their constants resolved at compile time; AND/OR/NOT pop their operands
+// and push the result. Matching a product is one pass over a flat op array,
+// with no map lookups, filter name comparisons or virtual calls, and no
+// errors: malformed filters are rejected by FilterFactory::compile.
+// The stack is sized from the program's peak depth, which is how many
+// operands wait at once (a right-nested AND chain of n leaves holds all n),
+// not how deeply the filter nests. Programs that fit INLINE_STACK slots
+// match without allocating.
+class CompiledFilter {
+    static constexpr size_t INLINE_STACK = 64;
+
+    enum class OpCode : uint8_t { CategoryEquals, PriceBetween, Never, And, Or, Not };
+
+    struct Op {
+        OpCode code;
+        uint32_t constant = 0; // CategoryEquals: index into categories
+        double low = 0.0;      // PriceBetween bounds
+        double high = 0.0;
+    };
+
+    vector<Op> ops;
+    vector<string> categories;
+    size_t depth = 0;     // stack size after the ops so far
+    size_t peakDepth = 0; // largest stack any product needs
+
+    void push(Op op, size_t pops, size_t pushes) {
+        if (depth < pops) {
+            throw runtime_error("Filter program pops an empty stack");
+        }
+        depth = depth - pops + pushes;
+        peakDepth = max(peakDepth, depth);
+        ops.push_back(op);
+    }
+
+public:
+    void emitCategoryEquals(const string& category) {
+        categories.push_back(category);
+        push({OpCode::CategoryEquals, static_cast<uint32_t>(categories.size() - 1)}, 0, 1);
+    }
+
+    void emitPriceBetween(double low, double high) {
+        push({OpCode::PriceBetween, 0, low, high}, 0, 1);
+    }
+
+    // Leaf that matches nothing (e.g. a CATEGORY that isn't a string)
+    void emitNever() {
+        push({OpCode::Never}, 0, 1);
+    }
+
+    void emitAnd() { push({OpCode::And}, 2, 1); }
+    void emitOr() { push({OpCode::Or}, 2, 1); }
+    void emitNot() { push({OpCode::Not}, 1, 1); }
+
+    bool isComplete() const {
+        return depth == 1;
+    }
+
+    bool matches(const Product& product) const {
+        if (peakDepth <= INLINE_STACK) {
+            bool stack[INLINE_STACK];
+            return run(product, stack);
+        }
+        unique_ptr<bool[]> stack = make_unique<bool[]>(peakDepth);
+        return run(product, stack.get());
+    }
+
+    size_t size() const {
+        return ops.size();
+    }
+
+private:
+    // stack has room for peakDepth values
+    bool run(const Product& product, bool* stack) const {
+        size_t top = 0;
+        for (const Op& op : ops) {
+            switch (op.code) {
+                case OpCode::CategoryEquals: stack[top++] = product.category == categories[op.constant]; break;
+                case OpCode::PriceBetween: stack[top++] = product.price >= op.low && product.price <= op.high; break;
+                case OpCode::Never: stack[top++] = false; break;
+                case OpCode::And: --top; stack[top - 1] = stack[top - 1] && stack[top]; break;
+                case OpCode::Or: --top; stack[top - 1] = stack[top - 1] || stack[top]; break;
+                case OpCode::Not: stack[top - 1] = !stack[top - 1]; break;
+            }
+        }
+        return stack[0];
+    }
+};
+
 // Interface for filtering criteria
 struct IFilteringCriteria {
     virtual ~IFilteringCriteria() = default;
@@ -47,6 +140,10 @@ struct IFilteringCriteria {
     virtual bool doesSupport(const string& filterName) const = 0;
 
     virtual bool doesProductMatch(const Product& product, const FilterValue& filterData) const = 0;
+
+    // Emits ops that leave doesProductMatch's answer on the program's stack;
+    // throws where doesProductMatch would throw for any product
+    virtual void compile(const FilterValue& filterData, CompiledFilter& program) const = 0;
 };
 
 // Category filter
@@ -62,6 +159,14 @@ public:
         }
         return false;
     }
+
+    void compile(const FilterValue& filterData, CompiledFilter& program) const override {
+        if (const string* val = filterData.getString()) {
+            program.emitCategoryEquals(*val);
+        } else {
+            program.emitNever();
+        }
+    }
 };
 
 // Price filter (expects map with "min" and/or "max")
@@ -73,25 +178,39 @@ public:
 
     bool doesProductMatch(const Product& product, const FilterValue& filterData) const override {
         if (const FilterMap* pmap = filterData.getMap()) {
-            double minVal = 0.0;
-            double maxVal = numeric_limits<double>::max();
+            auto [minVal, maxVal] = bounds(*pmap);
+            return product.price >= minVal && product.price <= maxVal;
+        }
+        return false;
+    }
 
-            auto itMin = pmap->find("min");
-            if (itMin != pmap->end()) {
-                if (const double* val = itMin->second.getDouble()) {
-                    minVal = *val;
-                }
+    void compile(const FilterValue& filterData, CompiledFilter& program) const override {
+        if (const FilterMap* pmap = filterData.getMap()) {
+            auto [minVal, maxVal] = bounds(*pmap);
+            program.emitPriceBetween(minVal, maxVal);
+        } else {
+            program.emitNever();
+        }
+    }
+
+private:
+    static pair<double, double> bounds(const FilterMap& pmap) {
+        double minVal = 0.0;
+        double maxVal = numeric_limits<double>::max();
+
+        auto itMin = pmap.find("min");
+        if (itMin != pmap.end()) {
+            if (const double* val = itMin->second.getDouble()) {
+                minVal = *val;
             }
-            auto itMax = pmap->find("max");
-            if (itMax != pmap->end()) {
-                if (const double* val = itMax->second.getDouble()) {
-                    maxVal = *val;
-                }
+        }
+        auto itMax = pmap.find("max");
+        if (itMax != pmap.end()) {
+            if (const double* val = itMax->second.getDouble()) {
+                maxVal = *val;
             }
-
-            return product.price >= minVal && product.price <= maxVal;
         }
-        return false;
+        return {minVal, maxVal};
     }
 };
 
@@ -103,6 +222,8 @@ public:
     }
 
     bool doesProductMatch(const Product& product, const FilterValue& filterData) const override;
+
+    void compile(const FilterValue& filterData, CompiledFilter& program) const override;
 };
 
 // Logical OR filter
@@ -113,6 +234,8 @@ public:
     }
 
     bool doesProductMatch(const Product& product, const FilterValue& filterData) const override;
+
+    void compile(const FilterValue& filterData, CompiledFilter& program) const override;
 };
 
 // Logical NOT filter
@@ -123,6 +246,8 @@ public:
     }
 
     bool doesProductMatch(const Product& product, const FilterValue& filterData) const override;
+
+    void compile(const FilterValue& filterData, CompiledFilter& program) const override;
 };
 
 // FilterFactory singleton
@@ -144,6 +269,28 @@ public:
     }
 
     bool doesProductMatch(const Product& product, const FilterValue& filter) {
+        const auto& [criteria, filterData] = resolve(filter);
+        return criteria.doesProductMatch(product, filterData);
+    }
+
+    // Validates the filter once and flattens it into a program; match many
+    // products with the result instead of calling doesProductMatch on each
+    CompiledFilter compile(const FilterValue& filter) {
+        CompiledFilter program;
+        compileInto(filter, program);
+        if (!program.isComplete()) {
+            throw runtime_error("Filter did not compile to a single condition");
+        }
+        return program;
+    }
+
+    void compileInto(const FilterValue& filter, CompiledFilter& program) {
+        const auto& [criteria, filterData] = resolve(filter);
+        criteria.compile(filterData, program);
+    }
+
+private:
+    pair<const IFilteringCriteria&, const FilterValue&> resolve(const FilterValue& filter) {
         if (const FilterMap* pmap = filter.getMap()) {
             if (pmap->size() != 1) {
                 throw runtime_error("FilterMap must contain exactly one filter");
@@ -152,7 +299,7 @@ public:
 
             for (auto& crit : criteriaList) {
                 if (crit->doesSupport(filterName)) {
-                    return crit->doesProductMatch(product, filterData);
+                    return {*crit, filterData};
                 }
             }
             throw runtime_error("No criteria found for filter: " + filterName);
@@ -175,6 +322,21 @@ bool AndFilteringCriteria::doesProductMatch(const Product& product, const Filter
     throw runtime_error("Invalid data for AND filter");
 }
 
+void AndFilteringCriteria::compile(const FilterValue& filterData, CompiledFilter& program) const {
+    if (const FilterMap* pmap = filterData.getMap()) {
+        auto itLeft = pmap->find("left");
+        auto itRight = pmap->find("right");
+        if (itLeft == pmap->end() || itRight == pmap->end()) {
+            throw runtime_error("AND filter requires 'left' and 'right'");
+        }
+        FilterFactory::getInstance().compileInto(itLeft->second, program);
+        FilterFactory::getInstance().compileInto(itRight->second, program);
+        program.emitAnd();
+        return;
+    }
+    throw runtime_error("Invalid data for AND filter");
+}
+
 // Implement OR filter logic
 bool OrFilteringCriteria::doesProductMatch(const Product& product, const FilterValue& filterData) const {
     if (const FilterMap* pmap = filterData.getMap()) {
@@ -189,6 +351,21 @@ bool OrFilteringCriteria::doesProductMatch(const Product& product, const FilterV
     throw runtime_error("Invalid data for OR filter");
 }
 
+void OrFilteringCriteria::compile(const FilterValue& filterData, CompiledFilter& program) const {
+    if (const FilterMap* pmap = filterData.getMap()) {
+        auto itLeft = pmap->find("left");
+        auto itRight = pmap->find("right");
+        if (itLeft == pmap->end() || itRight == pmap->end()) {
+            throw runtime_error("OR filter requires 'left' and 'right'");
+        }
+        FilterFactory::getInstance().compileInto(itLeft->second, program);
+        FilterFactory::getInstance().compileInto(itRight->second, program);
+        program.emitOr();
+        return;
+    }
+    throw runtime_error("Invalid data for OR filter");
+}
+
 // Implement NOT filter logic
 bool NotFilteringCriteria::doesProductMatch(const Product& product, const FilterValue& filterData) const {
     if (const FilterMap* pmap = filterData.getMap()) {
@@ -201,6 +378,19 @@ bool NotFilteringCriteria::doesProductMatch(const Product& product, const Filter
     throw runtime_error("Invalid data for NOT filter");
 }
 
+void NotFilteringCriteria::compile(const FilterValue& filterData, CompiledFilter& program) const {
+    if (const FilterMap* pmap = filterData.getMap()) {
+        auto itOperand = pmap->find("operand");
+        if (itOperand == pmap->end()) {
+            throw runtime_error("NOT filter requires 'operand'");
+        }
+        FilterFactory::getInstance().compileInto(itOperand->second, program);
+        program.emitNot();
+        return;
+    }
+    throw runtime_error("Invalid data for NOT filter");
+}
+
 // Main for testing
 int main() {
     vector<Product> products = {
@@ -248,5 +438,56 @@ int main() {
         }
     }
 
+    // Same filter, validated and flattened once
+    CompiledFilter compiled = factory.compile(filter);
+    cout << "\nProducts matching compiled filter (" << compiled.size() << " ops):\n";
+    for (const auto& p : products) {
+        if (compiled.matches(p)) {
+            cout << " - " << p.name << "\n";
+        }
+    }
+
+    // Scan a larger catalog both ways
+    vector<Product> catalog;
+    const char* categories[] = {"phone", "computer", "electronics", "tablet"};
+    for (int i = 0; i < 200000; ++i) {
+        catalog.push_back({to_string(i), "Product " + to_string(i), (i * 7919 % 100000) / 100.0, categories[i % 4]});
+    }
+    auto timeScan = [&](auto matches) {
+        auto start = chrono::steady_clock::now();
+        size_t count = 0;
+        for (const auto& p : catalog) {
+            count += matches(p);
+        }
+        double millis = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        return pair{count, millis};
+    };
+    auto [interpretedCount, interpretedMillis] = timeScan([&](const Product& p) { return factory.doesProductMatch(p, filter); });
+    auto [compiledCount, compiledMillis] = timeScan([&](const Product& p) { return compiled.matches(p); });
+    cout << "\nScanned " << catalog.size() << " products: interpreted " << interpretedMillis << " ms ("
+         << interpretedCount << " matches), compiled " << compiledMillis << " ms (" << compiledCount << " matches)\n";
+
+    // a AND (b AND (c AND ...)): 100 leaves wait on the stack at once
+    FilterValue chain = FilterMap{{"PRICE", FilterMap{{"min", 0.0}, {"max", 1000.0}}}};
+    for (int i = 0; i < 99; ++i) {
+        chain = FilterMap{{"AND", FilterMap{
+            {"left", FilterMap{{"CATEGORY", string("phone")}}},
+            {"right", chain}
+        }}};
+    }
+    CompiledFilter compiledChain = factory.compile(chain);
+    size_t chainMatches = 0;
+    for (const auto& p : products) {
+        chainMatches += compiledChain.matches(p);
+    }
+    cout << "\nRight-nested chain of 100 conditions: " << chainMatches << " matches compiled, "
+         << (factory.doesProductMatch(products[0], chain) ? "iPhone matches" : "no iPhone") << " interpreted\n";
+
+    try {
+        factory.compile(FilterMap{{"AND", FilterMap{{"left", FilterMap{{"CATEGORY", string("phone")}}}}}});
+    } catch (const exception& ex) {
+        cout << "Rejected at compile time: " << ex.what() << "\n";
+    }
+
     return 0;
 }
\ No newline at end of file
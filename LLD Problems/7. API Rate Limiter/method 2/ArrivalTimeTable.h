@@ -0,0 +1,301 @@
+#pragma once
+#include "ReaderPhases.h"
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Lock-free id -> GCRA arrival time table
+// An open-addressing array of pointers to entries {id, emission interval,
+// atomic TAT}. A decision finds its entry with plain loads, claims an empty
+// slot with one CAS the first time an id is seen, and updates the TAT with
+// a CAS loop, so no lock is taken on the decision path. The interval is
+// computed once, when the entry is created.
+// Idle entries (TAT in the past: a full bucket) are dropped by a rebuild.
+// It seals the old table's empty slots so nothing new lands there, retires
+// idle entries by swapping their TAT for RETIRED (which fails if a decision
+// got there first), then publishes a table sized for the survivors and
+// moves them over. A decision that meets a retired entry starts over; one
+// that misses in the new table while entries are still moving looks in the
+// old one. Old tables and retired entries are freed after a ReaderPhases
+// grace period.
+// A decision that fills the table past half rebuilds it unless a rebuild is
+// already running; evictIdle() rebuilds from a maintenance tick. Only a
+// first sighting can wait: while a rebuild seals the table, or if arrivals
+// outrun rebuilds and fill it to three quarters.
+class ArrivalTimeTable {
+public:
+    static constexpr int64_t RETIRED = INT64_MIN; // TAT of a dropped entry
+
+private:
+    struct Entry {
+        string id;
+        size_t hash = 0;
+        int64_t interval = 0;   // ns per token
+        atomic<int64_t> tat{0}; // 0: bucket starts full
+    };
+
+    struct Table {
+        size_t mask;
+        unique_ptr<atomic<Entry*>[]> slots;
+        atomic<size_t> claimed{0}; // slots taken or about to be
+
+        explicit Table(size_t capacity)
+            : mask(capacity - 1), slots(make_unique<atomic<Entry*>[]>(capacity)) {}
+
+        size_t capacity() const {
+            return mask + 1;
+        }
+    };
+
+    size_t minCapacity;
+    atomic<Table*> current;
+    atomic<Table*> previous{nullptr}; // being moved into current; null between rebuilds
+    mutex rebuildMutex;               // rebuilds, and decisions that found the table full
+    ReaderPhases readers;
+    Entry sealedMarker; // fills an old table's empty slots
+
+    static bool isLive(const Entry* entry) {
+        return entry->tat.load(memory_order_relaxed) != RETIRED;
+    }
+
+    static bool holds(const Entry* entry, const string& id, size_t hash) {
+        return entry->hash == hash && entry->id == id;
+    }
+
+    // Live entry for id in a sealed table being moved out of, or nullptr
+    Entry* findInOld(Table& table, const string& id, size_t hash) {
+        for (size_t probe = 0, i = hash & table.mask; probe <= table.mask; ++probe, i = (i + 1) & table.mask) {
+            Entry* entry = table.slots[i].load();
+            if (entry == &sealedMarker) {
+                return nullptr;
+            }
+            if (holds(entry, id, hash) && isLive(entry)) {
+                return entry;
+            }
+        }
+        return nullptr;
+    }
+
+    // Live entry for id in table, added at the end of its probe sequence if
+    // missing (taken from old while a rebuild moves entries, else created).
+    // &sealedMarker if the table has been sealed, nullptr if it is full.
+    template <typename IntervalOf>
+    Entry* findOrAdd(Table& table, Table* old, const string& id, size_t hash, IntervalOf& intervalOf, bool& grow) {
+        unique_ptr<Entry> fresh;
+        size_t i = hash & table.mask;
+        for (size_t probe = 0; probe <= table.mask;) {
+            Entry* entry = table.slots[i].load();
+            if (entry == &sealedMarker) {
+                return entry;
+            }
+            if (entry != nullptr) {
+                if (holds(entry, id, hash) && isLive(entry)) {
+                    return entry;
+                }
+                ++probe;
+                i = (i + 1) & table.mask;
+                continue;
+            }
+            Entry* candidate = old ? findInOld(*old, id, hash) : nullptr;
+            if (!candidate) {
+                if (!fresh) {
+                    fresh = make_unique<Entry>();
+                    fresh->id = id;
+                    fresh->hash = hash;
+                    fresh->interval = intervalOf();
+                }
+                candidate = fresh.get();
+            }
+            // The last quarter is kept for entries a rebuild moves in
+            size_t claimed = table.claimed.fetch_add(1);
+            if (claimed >= table.capacity() / 4 * 3) {
+                table.claimed.fetch_sub(1);
+                grow = true;
+                return nullptr;
+            }
+            if (table.slots[i].compare_exchange_strong(entry, candidate)) {
+                if (candidate == fresh.get()) {
+                    fresh.release();
+                }
+                grow = grow || claimed + 1 > table.capacity() / 2;
+                return candidate;
+            }
+            table.claimed.fetch_sub(1);
+            // Lost the slot: look again at whatever took it
+        }
+        return nullptr;
+    }
+
+    // Caller holds a pin. nullptr if the table is full.
+    template <typename IntervalOf>
+    Entry* resolve(const string& id, size_t hash, IntervalOf& intervalOf, bool& grow) {
+        while (true) {
+            Table* table = current.load();
+            Table* old = previous.load();
+            Entry* entry = findOrAdd(*table, old != table ? old : nullptr, id, hash, intervalOf, grow);
+            if (entry != &sealedMarker) {
+                return entry;
+            }
+            if (current.load() == table) {
+                this_thread::yield(); // sealed but its successor is not published yet
+            }
+        }
+    }
+
+    // Caller holds rebuildMutex; entry is live and not yet in table
+    static void moveInto(Table& table, Entry* moving) {
+        for (size_t probe = 0, i = moving->hash & table.mask; probe <= table.mask; ++probe, i = (i + 1) & table.mask) {
+            Entry* entry = table.slots[i].load();
+            if (entry == nullptr && table.slots[i].compare_exchange_strong(entry, moving)) {
+                table.claimed.fetch_add(1);
+                return;
+            }
+            if (holds(entry, moving->id, moving->hash)) {
+                return; // a decision moved it first
+            }
+        }
+        throw runtime_error("Rate limit table is full");
+    }
+
+    // Caller holds rebuildMutex and no pin. Returns how many entries were dropped.
+    size_t rebuild(long long now) {
+        Table* old = current.load();
+        vector<Entry*> retired;
+        size_t live = 0;
+        for (size_t i = 0; i <= old->mask; ++i) {
+            Entry* entry = old->slots[i].load();
+            if (entry == nullptr && old->slots[i].compare_exchange_strong(entry, &sealedMarker)) {
+                continue;
+            }
+            int64_t tat = entry->tat.load(memory_order_relaxed);
+            if (tat == RETIRED) {
+                continue;
+            }
+            if (tat <= now && entry->tat.compare_exchange_strong(tat, RETIRED, memory_order_relaxed)) {
+                retired.push_back(entry);
+                continue;
+            }
+            ++live;
+        }
+
+        // Moves fill at most a quarter, decisions stop at three quarters
+        size_t capacity = minCapacity;
+        while (capacity < 4 * live) {
+            capacity *= 2;
+        }
+        Table* next = new Table(capacity);
+        previous.store(old); // before current, so decisions on next know where to look
+        current.store(next);
+        for (size_t i = 0; i <= old->mask; ++i) {
+            Entry* entry = old->slots[i].load();
+            if (entry != &sealedMarker && isLive(entry)) {
+                moveInto(*next, entry);
+            }
+        }
+        previous.store(nullptr);
+
+        readers.waitForReaders();
+        delete old;
+        for (Entry* entry : retired) {
+            delete entry;
+        }
+        return retired.size();
+    }
+
+    // Caller holds rebuildMutex and no pin
+    void growIfCrowded(long long now) {
+        Table* table = current.load();
+        if (table->claimed.load() > table->capacity() / 2) {
+            rebuild(now);
+        }
+    }
+
+public:
+    // Capacities are powers of two; minCapacity is rounded up to one (at least 4)
+    explicit ArrivalTimeTable(size_t minCapacity_ = 1024) : minCapacity(4) {
+        while (minCapacity < minCapacity_) {
+            minCapacity *= 2;
+        }
+        current.store(new Table(minCapacity));
+    }
+
+    ~ArrivalTimeTable() {
+        Table* table = current.load();
+        for (size_t i = 0; i <= table->mask; ++i) {
+            delete table->slots[i].load();
+        }
+        delete table;
+    }
+
+    ArrivalTimeTable(const ArrivalTimeTable&) = delete;
+    ArrivalTimeTable& operator=(const ArrivalTimeTable&) = delete;
+
+    // Stores step(tat, interval) as id's TAT with a CAS, calling step again
+    // if another decision changed the TAT first; step returns nullopt to
+    // leave it alone. intervalOf() runs only when the entry is created.
+    // Returns whether a new TAT was stored.
+    template <typename IntervalOf, typename Step>
+    bool update(const string& id, long long now, IntervalOf intervalOf, Step step) {
+        size_t h = hash<string>()(id);
+        while (true) {
+            bool grow = false;
+            optional<bool> stored = [&]() -> optional<bool> {
+                ReaderPhases::Pin pin(readers);
+                while (true) {
+                    Entry* entry = resolve(id, h, intervalOf, grow);
+                    if (!entry) {
+                        return nullopt;
+                    }
+                    int64_t tat = entry->tat.load(memory_order_relaxed);
+                    while (tat != RETIRED) {
+                        optional<int64_t> next = step(tat, entry->interval);
+                        if (!next) {
+                            return false;
+                        }
+                        if (entry->tat.compare_exchange_weak(tat, *next, memory_order_relaxed)) {
+                            return true;
+                        }
+                    }
+                    // A rebuild dropped the entry meanwhile: use its successor
+                }
+            }();
+            if (stored) {
+                if (grow && rebuildMutex.try_lock()) {
+                    lock_guard lock(rebuildMutex, adopt_lock);
+                    growIfCrowded(now);
+                }
+                return *stored;
+            }
+            // Full: wait for the running rebuild, or run one, then try again
+            lock_guard lock(rebuildMutex);
+            growIfCrowded(now);
+        }
+    }
+
+    // Drops every idle entry; returns how many were dropped
+    size_t evictIdle(long long now) {
+        lock_guard lock(rebuildMutex);
+        return rebuild(now);
+    }
+
+    size_t size() {
+        lock_guard lock(rebuildMutex); // entries are only freed by rebuilds
+        Table* table = current.load();
+        size_t total = 0;
+        for (size_t i = 0; i <= table->mask; ++i) {
+            Entry* entry = table->slots[i].load();
+            total += entry != nullptr && isLive(entry);
+        }
+        return total;
+    }
+};
@@ -0,0 +1,163 @@
+#pragma once
+#include "GcraRateLimiter.h"
+#include "Clock.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Waiting rate limiter (leaky-bucket shaper on top of GCRA)
+// acquire() reserves the tokens straight away, even if they only refill in
+// the future, and returns a future that becomes ready when they do. Each
+// reservation pushes the entity's TAT further out, so an entity's waiters
+// form a FIFO by construction: each one's release time is its
+// predecessor's plus cost / rate, and a caller that only checks
+// (isRequestAllowed) sees the bucket empty until the queue has drained.
+// One dispatcher thread keeps the waiters in a min-heap by release time
+// and sleeps until the earliest is due, so nobody polls or retries.
+// Requests that fit in the bucket now never touch the queue or its lock.
+// maxWaiters bounds the queue across all entities; past it acquire()
+// throws and tryAcquireFor() returns false, with nothing reserved.
+// tryAcquireFor() knows its release time up front, so one that would wait
+// longer than its timeout fails immediately instead of queueing.
+// Waiters still queued when the limiter is destroyed get broken_promise.
+class AsyncRateLimiter : public IRateLimiter {
+    struct Waiter {
+        int64_t releaseAt; // clock ns
+        uint64_t sequence; // orders equal release times by arrival
+        promise<void> ready;
+    };
+
+    static bool releasedLater(const Waiter& a, const Waiter& b) {
+        return a.releaseAt != b.releaseAt ? a.releaseAt > b.releaseAt : a.sequence > b.sequence;
+    }
+
+    GcraRateLimiter gcra;
+    shared_ptr<IClock> clock;
+    size_t maxWaiters;
+    mutex mtx;
+    condition_variable wakeup;
+    vector<Waiter> waiters; // min-heap on releaseAt
+    uint64_t nextSequence = 0;
+    bool stopping = false;
+    thread dispatcher; // declared last: starts after the members it uses
+
+    void dispatch() {
+        unique_lock lock(mtx);
+        while (!stopping) {
+            if (waiters.empty()) {
+                wakeup.wait(lock);
+                continue;
+            }
+            int64_t now = clock->nowNanos();
+            vector<promise<void>> due;
+            while (!waiters.empty() && waiters.front().releaseAt <= now) {
+                pop_heap(waiters.begin(), waiters.end(), releasedLater);
+                due.push_back(std::move(waiters.back().ready));
+                waiters.pop_back();
+            }
+            if (!due.empty()) {
+                lock.unlock();
+                for (auto& ready : due) {
+                    ready.set_value();
+                }
+                lock.lock();
+                continue;
+            }
+            wakeup.wait_for(lock, chrono::nanoseconds(waiters.front().releaseAt - now));
+        }
+    }
+
+    // nullopt if the queue is full; the reservation is then handed back
+    optional<future<void>> enqueue(const IRateLimitingEntity& entity, int cost, int64_t releaseAt) {
+        lock_guard lock(mtx);
+        if (waiters.size() >= maxWaiters) {
+            gcra.release(entity, cost);
+            return nullopt;
+        }
+        waiters.push_back({releaseAt, nextSequence++, promise<void>()});
+        future<void> ready = waiters.back().ready.get_future();
+        push_heap(waiters.begin(), waiters.end(), releasedLater);
+        if (waiters.front().sequence == nextSequence - 1) {
+            wakeup.notify_one(); // new earliest waiter
+        }
+        return ready;
+    }
+
+    static future<void> readyFuture() {
+        promise<void> ready;
+        ready.set_value();
+        return ready.get_future();
+    }
+
+public:
+    AsyncRateLimiter(int capacity = 10, size_t maxWaiters_ = 10000, shared_ptr<IClock> clock_ = defaultClock())
+        : gcra(capacity, clock_), clock(std::move(clock_)), maxWaiters(maxWaiters_),
+          dispatcher([this] { dispatch(); }) {}
+
+    ~AsyncRateLimiter() {
+        {
+            lock_guard lock(mtx);
+            stopping = true;
+        }
+        wakeup.notify_one();
+        dispatcher.join();
+    }
+
+    AsyncRateLimiter(const AsyncRateLimiter&) = delete;
+    AsyncRateLimiter& operator=(const AsyncRateLimiter&) = delete;
+
+    // Never waits; queued waiters have already taken their tokens
+    bool isRequestAllowed(const IRateLimitingEntity& entity) override {
+        return gcra.isRequestAllowed(entity);
+    }
+
+    // Ready once cost tokens are available to this caller
+    future<void> acquire(const IRateLimitingEntity& entity, int cost = 1) {
+        int64_t releaseAt = *gcra.reserve(entity, cost, chrono::nanoseconds::max());
+        if (releaseAt <= clock->nowNanos()) {
+            return readyFuture();
+        }
+        optional<future<void>> ready = enqueue(entity, cost, releaseAt);
+        if (!ready) {
+            throw runtime_error("Too many queued rate limit waiters");
+        }
+        return std::move(*ready);
+    }
+
+    // Blocks until cost tokens are available, or returns false right away
+    // if that would take longer than timeout (or the queue is full)
+    bool tryAcquireFor(const IRateLimitingEntity& entity, int cost, chrono::nanoseconds timeout) {
+        optional<int64_t> releaseAt = gcra.reserve(entity, cost, timeout);
+        if (!releaseAt) {
+            return false;
+        }
+        if (*releaseAt <= clock->nowNanos()) {
+            return true;
+        }
+        optional<future<void>> ready = enqueue(entity, cost, *releaseAt);
+        if (!ready) {
+            return false;
+        }
+        ready->wait();
+        return true;
+    }
+
+    // Makes the dispatcher re-read the clock now. It wakes by itself when
+    // the earliest waiter is due; call this after moving a ManualClock.
+    void poll() {
+        lock_guard lock(mtx);
+        wakeup.notify_one();
+    }
+
+    size_t waiterCount() {
+        lock_guard lock(mtx);
+        return waiters.size();
+    }
+};
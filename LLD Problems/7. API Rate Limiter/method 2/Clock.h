@@ -0,0 +1,88 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+using namespace std;
+
+// Monotonic time source for the limiters. Inject a ManualClock in tests
+// instead of sleeping, or a CoarseClock on hot paths.
+class IClock {
+public:
+    virtual long long nowNanos() const = 0;
+    long long nowMillis() const {
+        return nowNanos() / 1000000;
+    }
+    virtual ~IClock() = default;
+};
+
+// Reads steady_clock on every call
+class SteadyClock : public IClock {
+public:
+    long long nowNanos() const override {
+        return chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+// Default clock for limiters constructed without one
+inline shared_ptr<IClock> defaultClock() {
+    static shared_ptr<IClock> clock = make_shared<SteadyClock>();
+    return clock;
+}
+
+// Coarse clock: a ticker thread reads steady_clock every tick and publishes
+// it through an atomic, so now is a plain load for every caller. Readings
+// lag by up to one tick (plus scheduling delay). Share one per process.
+class CoarseClock : public IClock {
+    atomic<long long> nanos;
+    atomic<bool> running{true};
+    thread ticker; // declared last: starts after the members it uses
+
+    static long long steadyNanos() {
+        return chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+public:
+    explicit CoarseClock(chrono::milliseconds tick = chrono::milliseconds(1))
+        : nanos(steadyNanos()), ticker([this, tick] {
+              while (running.load(memory_order_relaxed)) {
+                  this_thread::sleep_for(tick);
+                  nanos.store(steadyNanos(), memory_order_relaxed);
+              }
+          }) {}
+
+    ~CoarseClock() {
+        running = false;
+        ticker.join();
+    }
+
+    CoarseClock(const CoarseClock&) = delete;
+    CoarseClock& operator=(const CoarseClock&) = delete;
+
+    long long nowNanos() const override {
+        return nanos.load(memory_order_relaxed);
+    }
+};
+
+// Clock that only moves when told to, for deterministic tests
+class ManualClock : public IClock {
+    atomic<long long> nanos;
+
+public:
+    explicit ManualClock(long long startMillis = 0)
+        : nanos(startMillis * 1000000) {}
+
+    long long nowNanos() const override {
+        return nanos.load(memory_order_relaxed);
+    }
+
+    void advanceMillis(long long millis) {
+        advanceNanos(millis * 1000000);
+    }
+
+    void advanceNanos(long long delta) {
+        nanos.fetch_add(delta, memory_order_relaxed);
+    }
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include "RateLimitingEntity.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace std;
+
+// Dense index of an interned entity: 0, 1, 2, ... in order of first sight
+using EntityHandle = uint32_t;
+
+// Interning table for rate limiting entities
+// Resolves an entity's id to a dense handle once, at setup, and keeps its
+// refill rule alive, so limiters can index flat arrays by handle and read
+// the rule through a plain reference instead of copying the id and the
+// shared_ptr on every request. Handles are never reused, so this suits a
+// known set of long-lived entities (APIs, tenants, plans); high-cardinality
+// or late-arriving ids belong in the string-keyed limiters, which evict
+// idle entries.
+// intern() is setup-only: call it from one thread before building limiters
+// over the registry. After that the registry is read-only, and find(),
+// ruleOf() and idOf() are safe from any number of threads.
+class EntityRegistry {
+    unordered_map<string, EntityHandle> handles;
+    vector<string> ids;
+    vector<shared_ptr<IRefillRule>> rules;
+
+public:
+    EntityHandle intern(const IRateLimitingEntity& entity) {
+        auto [it, inserted] = handles.try_emplace(entity.getId(), static_cast<EntityHandle>(ids.size()));
+        if (inserted) {
+            ids.push_back(it->first);
+            rules.push_back(entity.getRefillRule());
+        }
+        return it->second;
+    }
+
+    // nullopt if the entity was never interned
+    optional<EntityHandle> find(const IRateLimitingEntity& entity) const {
+        auto it = handles.find(entity.getId());
+        if (it == handles.end()) {
+            return nullopt;
+        }
+        return it->second;
+    }
+
+    IRefillRule& ruleOf(EntityHandle handle) const {
+        return *rules[handle];
+    }
+
+    const string& idOf(EntityHandle handle) const {
+        return ids[handle];
+    }
+
+    size_t size() const {
+        return ids.size();
+    }
+};
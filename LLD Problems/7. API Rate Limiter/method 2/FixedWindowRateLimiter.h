@@ -0,0 +1,51 @@
+#pragma once
+#include "RateLimiter.h"
+#include "ShardedEntityTable.h"
+#include "Clock.h"
+#include <memory>
+using namespace std;
+
+// Fixed Window rate limiter implementation
+class FixedWindowRateLimiter : public IRateLimiter {
+    struct Window {
+        long long windowEnd = 0; // ms; the first request at or after it starts a new window
+        int count = 0;
+
+        bool isIdle(long long now) const {
+            return now >= windowEnd;
+        }
+    };
+    ShardedEntityTable<Window> windows;
+
+    const int maxRequests = 10;
+    const int windowSizeMillis = 5000;
+    shared_ptr<IClock> clock;
+
+public:
+    FixedWindowRateLimiter(shared_ptr<IClock> clock_ = defaultClock())
+        : clock(std::move(clock_)) {}
+
+    bool isRequestAllowed(const IRateLimitingEntity& entity) override {
+        long long now = clock->nowMillis();
+        return windows.withEntry(entity.getId(), now, [&](Window& window) {
+            if (now >= window.windowEnd) {
+                // Start a new window
+                window = { now + windowSizeMillis, 1 };
+                return true;
+            }
+            if (window.count < maxRequests) {
+                window.count++;
+                return true;
+            }
+            return false;
+        });
+    }
+
+    size_t evictIdle() {
+        return windows.evictIdle(clock->nowMillis());
+    }
+
+    size_t entityCount() {
+        return windows.size();
+    }
+};
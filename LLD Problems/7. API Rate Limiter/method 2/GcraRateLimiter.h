@@ -0,0 +1,106 @@
+#pragma once
+#include "RateLimiter.h"
+#include "ArrivalTimeTable.h"
+#include "Clock.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <vector>
+using namespace std;
+
+// GCRA (Generic Cell Rate Algorithm) rate limiter
+// Behaves like a token bucket of `capacity` tokens that refills continuously
+// at the entity's refill rate, but the only state per entity is one atomic
+// "theoretical arrival time" (TAT): when the bucket would be full again.
+// Each request pushes TAT out by one emission interval (1 / rate) and is
+// allowed while TAT stays within capacity intervals of now, so the update is
+// a single compare-and-swap loop and is safe to call from any thread.
+// TATs live in an ArrivalTimeTable, so finding one takes no lock either and
+// the entity's refill rule is read only the first time it is seen.
+// checkAll() charges several buckets (user, API, user x API) all or nothing:
+// it reserves from each in turn and hands back the reservations if a later
+// one rejects, so no lock spans more than one entity. A request racing with
+// a rolled-back reservation may see the bucket briefly fuller than it is.
+// reserve() may also take tokens that only refill up to maxWait from now
+// (pushing TAT past the burst limit), returning when they become available;
+// AsyncRateLimiter queues callers on that to shape traffic.
+class GcraRateLimiter : public IRateLimiter {
+    int capacity;
+    ArrivalTimeTable tats;
+    shared_ptr<IClock> clock;
+
+    static int64_t intervalOf(const IRateLimitingEntity& entity) {
+        return static_cast<int64_t>(1e9 / entity.getRefillRule()->tokensPerSecond());
+    }
+
+    // Takes cost tokens if they are available by now + maxWait and returns
+    // when that is; otherwise changes nothing
+    optional<int64_t> reserveAt(const IRateLimitingEntity& entity, int cost, int64_t now, int64_t maxWait) {
+        int64_t availableAt = 0;
+        bool reserved = tats.update(entity.getId(), now, [&] { return intervalOf(entity); },
+                                    [&](int64_t tat, int64_t interval) -> optional<int64_t> {
+            int64_t next = max(tat, now) + interval * cost;
+            availableAt = next - interval * capacity;
+            if (availableAt - now > maxWait) {
+                return nullopt;
+            }
+            return next;
+        });
+        if (!reserved) {
+            return nullopt;
+        }
+        return availableAt;
+    }
+
+    bool tryReserve(const IRateLimitingEntity& entity, int cost, int64_t now) {
+        return reserveAt(entity, cost, now, 0).has_value();
+    }
+
+    // Hands back tokens taken by reserveAt
+    void release(const IRateLimitingEntity& entity, int cost, int64_t now) {
+        tats.update(entity.getId(), now, [&] { return intervalOf(entity); },
+                    [&](int64_t tat, int64_t interval) -> optional<int64_t> { return tat - interval * cost; });
+    }
+
+public:
+    GcraRateLimiter(int capacity_ = 10, shared_ptr<IClock> clock_ = defaultClock())
+        : capacity(capacity_), clock(std::move(clock_)) {}
+
+    bool isRequestAllowed(const IRateLimitingEntity& entity) override {
+        return tryReserve(entity, 1, clock->nowNanos());
+    }
+
+    // Allowed only if every entity's bucket has cost tokens; then all pay
+    bool checkAll(const vector<const IRateLimitingEntity*>& entities, int cost = 1) {
+        int64_t now = clock->nowNanos();
+        for (size_t i = 0; i < entities.size(); ++i) {
+            if (!tryReserve(*entities[i], cost, now)) {
+                while (i-- > 0) {
+                    release(*entities[i], cost, now);
+                }
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Clock time (ns) at which the reserved tokens are available, possibly
+    // already past; nullopt (and nothing taken) if later than maxWait from now
+    optional<int64_t> reserve(const IRateLimitingEntity& entity, int cost, chrono::nanoseconds maxWait) {
+        return reserveAt(entity, cost, clock->nowNanos(), maxWait.count());
+    }
+
+    // Hands back tokens taken by reserve()
+    void release(const IRateLimitingEntity& entity, int cost) {
+        release(entity, cost, clock->nowNanos());
+    }
+
+    size_t evictIdle() {
+        return tats.evictIdle(clock->nowNanos());
+    }
+
+    size_t entityCount() {
+        return tats.size();
+    }
+};
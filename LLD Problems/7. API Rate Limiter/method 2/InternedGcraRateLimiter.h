@@ -0,0 +1,97 @@
+#pragma once
+#include "RateLimiter.h"
+#include "EntityRegistry.h"
+#include "Clock.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+using namespace std;
+
+// GCRA rate limiter over interned entity handles
+// Same decision as GcraRateLimiter, but each entity's TAT and emission
+// interval sit in one flat slot array indexed by EntityHandle, so a
+// decision is an array index, a clock read and a CAS loop on the slot's
+// TAT: no hashing, allocation, refcount or lock. One limiter is shared by
+// every worker thread. The array is sized (and each rule read) when the
+// limiter is built, so intern every entity first; a handle interned later
+// is rejected with an exception.
+// checkAll() charges several handles all or nothing with the same
+// reserve-then-roll-back scheme as GcraRateLimiter, with the same brief
+// over-allowance window for a request racing with a rollback.
+class InternedGcraRateLimiter : public IRateLimiter {
+    struct Slot {
+        atomic<int64_t> tat{0}; // ns; 0: bucket starts full
+        int64_t interval = 0;   // ns per token; written once at construction
+    };
+
+    shared_ptr<EntityRegistry> registry;
+    int capacity;
+    size_t slotCount;
+    unique_ptr<Slot[]> slots;
+    shared_ptr<IClock> clock;
+
+    Slot& slotOf(EntityHandle handle) {
+        if (handle >= slotCount) {
+            throw out_of_range("Entity handle " + to_string(handle) + " was interned after the limiter was built");
+        }
+        return slots[handle];
+    }
+
+public:
+    InternedGcraRateLimiter(shared_ptr<EntityRegistry> registry_, int capacity_ = 10,
+                            shared_ptr<IClock> clock_ = defaultClock())
+        : registry(std::move(registry_)), capacity(capacity_), slotCount(registry->size()),
+          slots(make_unique<Slot[]>(slotCount)), clock(std::move(clock_)) {
+        for (size_t h = 0; h < slotCount; ++h) {
+            slots[h].interval = static_cast<int64_t>(1e9 / registry->ruleOf(static_cast<EntityHandle>(h)).tokensPerSecond());
+        }
+    }
+
+    // Takes cost tokens if the bucket has them; otherwise changes nothing
+    bool tryConsume(EntityHandle handle, int cost, int64_t now) {
+        Slot& slot = slotOf(handle);
+        int64_t current = slot.tat.load(memory_order_relaxed);
+        while (true) {
+            int64_t next = max(current, now) + slot.interval * cost;
+            if (next - now > slot.interval * capacity) {
+                return false;
+            }
+            if (slot.tat.compare_exchange_weak(current, next, memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+
+    bool isRequestAllowed(EntityHandle handle) {
+        return tryConsume(handle, 1, clock->nowNanos());
+    }
+
+    // Allowed only if every handle's bucket has cost tokens; then all pay
+    bool checkAll(span<const EntityHandle> handles, int cost = 1) {
+        int64_t now = clock->nowNanos();
+        for (size_t i = 0; i < handles.size(); ++i) {
+            if (!tryConsume(handles[i], cost, now)) {
+                while (i-- > 0) {
+                    Slot& slot = slots[handles[i]];
+                    slot.tat.fetch_sub(slot.interval * cost, memory_order_relaxed);
+                }
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Slow path for callers without a handle: a read-only lookup of the id.
+    // Entities that were never interned throw rather than being added.
+    bool isRequestAllowed(const IRateLimitingEntity& entity) override {
+        optional<EntityHandle> handle = registry->find(entity);
+        if (!handle) {
+            throw out_of_range("Entity was not interned: " + entity.getId());
+        }
+        return isRequestAllowed(*handle);
+    }
+};
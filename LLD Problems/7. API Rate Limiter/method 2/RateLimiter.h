@@ -0,0 +1,10 @@
+#pragma once
+#include "RateLimitingEntity.h"
+using namespace std;
+
+// Interface for rate limiter algorithms
+class IRateLimiter {
+public:
+    virtual bool isRequestAllowed(const IRateLimitingEntity& entity) = 0;
+    virtual ~IRateLimiter() = default;
+};
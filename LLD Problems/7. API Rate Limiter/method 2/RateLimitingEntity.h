@@ -0,0 +1,89 @@
+#pragma once
+#include "RefillRule.h"
+#include <memory>
+#include <string>
+#include <string_view>
+using namespace std;
+
+// Interface for entities subject to rate limiting
+class IRateLimitingEntity {
+public:
+    // Neither copies, so limiters can look entities up without allocating
+    virtual const string& getId() const = 0;
+    // Which rule applies in a RuleTable ("user", "api", ...)
+    virtual string_view getKind() const = 0;
+    virtual shared_ptr<IRefillRule> getRefillRule() const = 0;
+    virtual ~IRateLimitingEntity() = default;
+};
+
+// User entity
+class User : public IRateLimitingEntity {
+    string userId;
+    shared_ptr<IRefillRule> refillRule;
+
+public:
+    User(const string& id)
+        : userId(id),
+          refillRule(make_shared<ConstantRateRefillRule>(5, 5000)) // 5 tokens per 5 seconds
+    {}
+
+    const string& getId() const override {
+        return userId;
+    }
+
+    string_view getKind() const override {
+        return "user";
+    }
+
+    shared_ptr<IRefillRule> getRefillRule() const override {
+        return refillRule;
+    }
+};
+
+// API entity
+class API : public IRateLimitingEntity {
+    string apiName;
+    shared_ptr<IRefillRule> refillRule;
+
+public:
+    API(const string& name)
+        : apiName(name),
+          refillRule(make_shared<ConstantRateRefillRule>(3, 3000)) // 3 tokens per 3 seconds
+    {}
+
+    const string& getId() const override {
+        return apiName;
+    }
+
+    string_view getKind() const override {
+        return "api";
+    }
+
+    shared_ptr<IRefillRule> getRefillRule() const override {
+        return refillRule;
+    }
+};
+
+// User x API entity: limits one user's calls to one API
+class UserPerAPI : public IRateLimitingEntity {
+    string id;
+    shared_ptr<IRefillRule> refillRule;
+
+public:
+    UserPerAPI(const User& user, const API& api)
+        : id(user.getId() + "-" + api.getId()),
+          refillRule(make_shared<ConstantRateRefillRule>(2, 2000)) // 2 tokens per 2 seconds
+    {}
+
+    const string& getId() const override {
+        return id;
+    }
+
+    string_view getKind() const override {
+        return "user-api";
+    }
+
+    shared_ptr<IRefillRule> getRefillRule() const override {
+        return refillRule;
+    }
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <thread>
+using namespace std;
+
+// Grace periods for data that readers use without locking (RCU style)
+// A reader pins for as long as it may hold pointers into shared data. A
+// writer that has unpublished something calls waitForReaders() and may free
+// it once that returns. Readers count themselves, per phase, in their
+// thread's stripe of counters (one uncontended atomic add and sub); the
+// writer flips the phase and waits for the old phase's counts to drain, so
+// it waits out the readers already in flight and readers never wait.
+class ReaderPhases {
+    struct alignas(64) Stripe {
+        atomic<uint64_t> active[2] = {0, 0};
+    };
+    static constexpr size_t STRIPES = 16;
+
+    atomic<uint32_t> phase{0};
+    Stripe stripes[STRIPES];
+
+    static size_t stripeOfThisThread() {
+        static thread_local size_t stripe = hash<thread::id>()(this_thread::get_id()) % STRIPES;
+        return stripe;
+    }
+
+public:
+    // Counts the calling thread as a reader for its lifetime
+    class Pin {
+        atomic<uint64_t>* count;
+
+    public:
+        explicit Pin(ReaderPhases& phases) {
+            Stripe& stripe = phases.stripes[stripeOfThisThread()];
+            while (true) {
+                uint32_t seen = phases.phase.load();
+                count = &stripe.active[seen];
+                count->fetch_add(1);
+                // A writer that flipped before the add may already have
+                // checked this count, so only a phase still current holds
+                if (phases.phase.load() == seen) {
+                    return;
+                }
+                count->fetch_sub(1, memory_order_release);
+            }
+        }
+
+        ~Pin() {
+            count->fetch_sub(1, memory_order_release);
+        }
+
+        Pin(const Pin&) = delete;
+        Pin& operator=(const Pin&) = delete;
+    };
+
+    // Callers serialize. Returns once every reader pinned before the call
+    // has unpinned; the caller must not hold a pin itself.
+    void waitForReaders() {
+        uint32_t oldPhase = phase.fetch_xor(1);
+        for (Stripe& stripe : stripes) {
+            while (stripe.active[oldPhase].load() != 0) {
+                this_thread::yield();
+            }
+        }
+    }
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include "TokensBucket.h"
+#include <algorithm>
+using namespace std;
+
+// Interface for refill rule
+// Refill state lives in the bucket and the time comes from the limiter's
+// clock, so a rule can be shared by any number of buckets (and threads) and
+// dropping a bucket forgets everything about it.
+class IRefillRule {
+public:
+    virtual void refillBucket(TokensBucket& bucket, long long nowMillis) = 0;
+    // When the bucket will be full again if nothing consumes from it
+    virtual long long fullAtMillis(const TokensBucket& bucket) const = 0;
+    // Average refill rate, for limiters that refill continuously (e.g. GCRA)
+    virtual double tokensPerSecond() const = 0;
+    virtual ~IRefillRule() = default;
+};
+
+// Constant rate refill rule for token bucket
+class ConstantRateRefillRule : public IRefillRule {
+    int tokensToAdd;
+    int windowMillis;
+
+public:
+    ConstantRateRefillRule(int tokensToAdd_, int windowMillis_)
+        : tokensToAdd(tokensToAdd_), windowMillis(windowMillis_) {}
+
+    void refillBucket(TokensBucket& bucket, long long now) override {
+        long long lastRefill = bucket.getLastRefillMillis();
+        if (lastRefill < 0) {
+            bucket.setLastRefillMillis(now);
+            return;
+        }
+
+        // Add tokens for every whole window that has passed
+        long long windows = (now - lastRefill) / windowMillis;
+        if (windows > 0) {
+            bucket.refill(static_cast<int>(min<long long>(windows * tokensToAdd, bucket.getCapacity())));
+            bucket.setLastRefillMillis(lastRefill + windows * windowMillis);
+        }
+    }
+
+    long long fullAtMillis(const TokensBucket& bucket) const override {
+        int missing = bucket.getCapacity() - bucket.getTokens();
+        long long windows = (missing + tokensToAdd - 1) / tokensToAdd;
+        return bucket.getLastRefillMillis() + windows * windowMillis;
+    }
+
+    double tokensPerSecond() const override {
+        return tokensToAdd * 1000.0 / windowMillis;
+    }
+};
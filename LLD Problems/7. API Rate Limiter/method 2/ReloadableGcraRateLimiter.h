@@ -0,0 +1,158 @@
+#pragma once
+#include "RateLimiter.h"
+#include "ReaderPhases.h"
+#include "RuleTable.h"
+#include "ShardedEntityTable.h"
+#include "Clock.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+using namespace std;
+
+// GCRA rate limiter whose limits come from a RuleTable that can be
+// replaced while requests are in flight
+// reload() publishes a new table with one atomic pointer store (RCU
+// style): a decision loads the pointer and compares the table's version
+// with the one its entity's state was written under. States live in a
+// ShardedEntityTable, so a decision holds its shard's shared lock around
+// the CAS loop, and the first decision for an entity after a reload takes
+// the shard's exclusive lock once to adopt the new rule. Each state
+// carries its own capacity and interval; adopting rescales the bucket so
+// it keeps the same fraction of its capacity (a bucket 40% spent of 10 is
+// 40% spent of 20), and a decision still holding an older table never
+// rolls a newer state back. Entities no rule covers use their own refill
+// rule and defaultCapacity. A decision allocates nothing once its entity
+// is tracked.
+// A decision pins the table it reads with ReaderPhases. reload() swaps the
+// table and frees the old one after a grace period: it waits out the
+// decisions already in flight, which never wait for it. Only the current
+// table is kept.
+class ReloadableGcraRateLimiter : public IRateLimiter {
+    struct Generation {
+        RuleTable rules;
+        uint32_t version;
+    };
+
+    struct ArrivalTime {
+        atomic<int64_t> tat{0}; // 0: bucket starts full
+        // Written under the shard's exclusive lock only
+        uint32_t version = 0; // generation the rule below came from; 0: none yet
+        int capacity = 0;
+        int64_t interval = 0; // ns per token
+
+        bool isIdle(long long now) const {
+            return tat.load(memory_order_relaxed) <= now;
+        }
+    };
+
+    int defaultCapacity;
+    atomic<const Generation*> current{nullptr};
+    mutex reloadMutex; // serializes reload(); decisions never take it
+    uint32_t nextVersion = 1;
+    ReaderPhases readers; // of current
+    ShardedEntityTable<ArrivalTime> tats;
+    shared_ptr<IClock> clock;
+
+    LimitRule ruleFor(const Generation& generation, const IRateLimitingEntity& entity) const {
+        if (const LimitRule* rule = generation.rules.find(entity)) {
+            return *rule;
+        }
+        return {defaultCapacity, entity.getRefillRule()->tokensPerSecond()};
+    }
+
+    // Caller holds the shard's exclusive lock
+    static void adopt(ArrivalTime& state, const LimitRule& rule, uint32_t version, int64_t now) {
+        int64_t interval = static_cast<int64_t>(1e9 / rule.tokensPerSecond);
+        int64_t tat = state.tat.load(memory_order_relaxed);
+        if (state.version != 0 && tat > now) {
+            double spent = static_cast<double>(tat - now) / state.interval / state.capacity;
+            state.tat.store(now + static_cast<int64_t>(spent * rule.capacity * interval), memory_order_relaxed);
+        }
+        state.version = version;
+        state.capacity = rule.capacity;
+        state.interval = interval;
+    }
+
+    static bool tryTake(ArrivalTime& state, int64_t now) {
+        int64_t current = state.tat.load(memory_order_relaxed);
+        while (true) {
+            int64_t next = max(current, now) + state.interval;
+            if (next - now > state.interval * state.capacity) {
+                return false;
+            }
+            if (state.tat.compare_exchange_weak(current, next, memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+
+public:
+    ReloadableGcraRateLimiter(RuleTable rules = RuleTable(), int defaultCapacity_ = 10,
+                              shared_ptr<IClock> clock_ = defaultClock())
+        : defaultCapacity(defaultCapacity_), clock(std::move(clock_)) {
+        reload(std::move(rules));
+    }
+
+    ~ReloadableGcraRateLimiter() {
+        delete current.load();
+    }
+
+    ReloadableGcraRateLimiter(const ReloadableGcraRateLimiter&) = delete;
+    ReloadableGcraRateLimiter& operator=(const ReloadableGcraRateLimiter&) = delete;
+
+    // Buckets move to the new rules on their next decision. Returns after
+    // the decisions still reading the old rules have finished.
+    void reload(RuleTable rules) {
+        auto generation = make_unique<Generation>(Generation{std::move(rules), 0});
+        lock_guard lock(reloadMutex);
+        generation->version = nextVersion++;
+        const Generation* replaced = current.exchange(generation.release());
+        if (replaced) {
+            readers.waitForReaders();
+            delete replaced;
+        }
+    }
+
+    // A file that fails to parse throws and leaves the current rules in place
+    void reloadFrom(const string& path) {
+        reload(RuleTable::load(path));
+    }
+
+    bool isRequestAllowed(const IRateLimitingEntity& entity) override {
+        ReaderPhases::Pin pin(readers);
+        const Generation* generation = current.load();
+        const string& id = entity.getId();
+        int64_t now = clock->nowNanos();
+        optional<bool> allowed = tats.withSharedEntry(id, now, [&](ArrivalTime& state) -> optional<bool> {
+            if (state.version < generation->version) {
+                return nullopt;
+            }
+            return tryTake(state, now);
+        });
+        if (allowed) {
+            return *allowed;
+        }
+        return tats.withEntry(id, now, [&](ArrivalTime& state) {
+            if (state.version < generation->version) {
+                adopt(state, ruleFor(*generation, entity), generation->version, now);
+            }
+            return tryTake(state, now);
+        });
+    }
+
+    uint32_t rulesVersion() {
+        ReaderPhases::Pin pin(readers);
+        return current.load()->version;
+    }
+
+    size_t evictIdle() {
+        return tats.evictIdle(clock->nowNanos());
+    }
+
+    size_t entityCount() {
+        return tats.size();
+    }
+};
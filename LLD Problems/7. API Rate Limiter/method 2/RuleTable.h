@@ -0,0 +1,98 @@
+#pragma once
+#include "RateLimitingEntity.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+using namespace std;
+
+// Limit for one kind of entity (or one entity): a bucket of `capacity`
+// tokens refilled at tokensPerSecond
+struct LimitRule {
+    int capacity;
+    double tokensPerSecond;
+};
+
+// Immutable table of limit rules, parsed from a config file with one rule
+// per line:
+//
+//     # selector   capacity  tokens  windowMillis
+//     user         5         5       5000
+//     api          3         3       3000
+//     user:alice   20        20      5000
+//
+// A selector is an entity kind (getKind()) or kind:id for one entity; the
+// id rule wins. Blank lines and lines starting with # are ignored.
+class RuleTable {
+    // Lets find() look up string_views without building a string
+    struct NameHash {
+        using is_transparent = void;
+        size_t operator()(string_view name) const {
+            return hash<string_view>()(name);
+        }
+    };
+    template <typename V>
+    using ByName = unordered_map<string, V, NameHash, equal_to<>>;
+
+    ByName<LimitRule> byKind;
+    ByName<ByName<LimitRule>> byId; // kind -> id -> rule
+
+public:
+    // Throws with the line number on malformed input
+    static RuleTable parse(istream& in) {
+        RuleTable table;
+        string line;
+        for (int lineNumber = 1; getline(in, line); ++lineNumber) {
+            istringstream fields(line);
+            string selector;
+            if (!(fields >> selector) || selector[0] == '#') {
+                continue;
+            }
+            int capacity, tokens, windowMillis;
+            string extra;
+            if (!(fields >> capacity >> tokens >> windowMillis) || (fields >> extra)
+                || capacity <= 0 || tokens <= 0 || windowMillis <= 0) {
+                throw runtime_error("Invalid rate limit rule on line " + to_string(lineNumber) + ": " + line);
+            }
+            LimitRule rule{capacity, tokens * 1000.0 / windowMillis};
+            size_t colon = selector.find(':');
+            if (colon != string::npos) {
+                table.byId[selector.substr(0, colon)][selector.substr(colon + 1)] = rule;
+            } else {
+                table.byKind[selector] = rule;
+            }
+        }
+        return table;
+    }
+
+    static RuleTable load(const string& path) {
+        ifstream in(path);
+        if (!in) {
+            throw runtime_error("Cannot open rate limit rules: " + path);
+        }
+        return parse(in);
+    }
+
+    // nullptr if no rule covers the entity
+    const LimitRule* find(const IRateLimitingEntity& entity) const {
+        string_view kind = entity.getKind();
+        if (auto ids = byId.find(kind); ids != byId.end()) {
+            auto it = ids->second.find(entity.getId());
+            if (it != ids->second.end()) {
+                return &it->second;
+            }
+        }
+        auto it = byKind.find(kind);
+        return it != byKind.end() ? &it->second : nullptr;
+    }
+
+    size_t size() const {
+        size_t total = byKind.size();
+        for (const auto& [kind, ids] : byId) {
+            total += ids.size();
+        }
+        return total;
+    }
+};
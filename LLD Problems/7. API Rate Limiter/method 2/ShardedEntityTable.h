@@ -0,0 +1,123 @@
+#pragma once
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+using namespace std;
+
+// Per-entity limiter state: created on first use, and idle once it is the
+// same as a fresh state (e.g. a bucket that has refilled completely)
+template <typename State>
+concept IdleAwareState = default_initializable<State> && requires(const State& state, long long now) {
+    { state.isIdle(now) } -> convertible_to<bool>;
+};
+
+// Sharded concurrent id -> State table for the rate limiters
+// Ids hash to one of N shards, each with its own lock, so decisions for
+// different entities rarely contend. Idle entries are dropped because a
+// missing entry behaves exactly like a fresh one: each shard sweeps itself
+// when an insert finds it at twice its size after the last sweep, which
+// keeps memory proportional to recently active entities at amortized O(1)
+// per insert. evictIdle() sweeps every shard, e.g. from a maintenance tick.
+// `now` is in whatever unit the State's isIdle() expects.
+template <typename State>
+class ShardedEntityTable {
+    struct alignas(64) Shard {
+        shared_mutex mutex;
+        unordered_map<string, State> entries;
+        size_t sweepAt = 0;
+    };
+
+    unique_ptr<Shard[]> shards;
+    size_t shardMask;
+    size_t minSweepSize;
+
+    Shard& shardFor(const string& id) {
+        return shards[hash<string>()(id) & shardMask];
+    }
+
+    // Caller holds the shard's exclusive lock
+    size_t sweep(Shard& shard, long long now) {
+        size_t evicted = erase_if(shard.entries, [now](const auto& entry) { return entry.second.isIdle(now); });
+        shard.sweepAt = max(minSweepSize, 2 * shard.entries.size());
+        return evicted;
+    }
+
+    // Caller holds the shard's exclusive lock
+    State& findOrInsert(Shard& shard, const string& id, long long now) {
+        // Checked here rather than on the class: limiters nest their State,
+        // which is still incomplete where the table member is declared
+        static_assert(IdleAwareState<State>);
+        auto it = shard.entries.find(id);
+        if (it != shard.entries.end()) {
+            return it->second;
+        }
+        if (shard.entries.size() >= shard.sweepAt) {
+            sweep(shard, now);
+        }
+        return shard.entries.try_emplace(id).first->second;
+    }
+
+public:
+    // shardCount is rounded up to a power of two
+    explicit ShardedEntityTable(size_t shardCount = 16, size_t minSweepSize_ = 1024)
+        : minSweepSize(minSweepSize_) {
+        size_t count = 1;
+        while (count < shardCount) {
+            count *= 2;
+        }
+        shards = make_unique<Shard[]>(count);
+        shardMask = count - 1;
+        for (size_t i = 0; i < count; ++i) {
+            shards[i].sweepAt = minSweepSize;
+        }
+    }
+
+    // Runs f(state) with the entity's shard locked exclusively
+    template <typename F>
+    auto withEntry(const string& id, long long now, F&& f) {
+        Shard& shard = shardFor(id);
+        unique_lock lock(shard.mutex);
+        return f(findOrInsert(shard, id, now));
+    }
+
+    // Runs f(state) under the shard's shared lock, for states that
+    // synchronize themselves (atomics). Only a first sighting locks exclusively.
+    template <typename F>
+    auto withSharedEntry(const string& id, long long now, F&& f) {
+        Shard& shard = shardFor(id);
+        {
+            shared_lock lock(shard.mutex);
+            auto it = shard.entries.find(id);
+            if (it != shard.entries.end()) {
+                return f(it->second);
+            }
+        }
+        unique_lock lock(shard.mutex);
+        return f(findOrInsert(shard, id, now));
+    }
+
+    // Drops every idle entry; returns how many were dropped
+    size_t evictIdle(long long now) {
+        size_t evicted = 0;
+        for (size_t i = 0; i <= shardMask; ++i) {
+            unique_lock lock(shards[i].mutex);
+            evicted += sweep(shards[i], now);
+        }
+        return evicted;
+    }
+
+    size_t size() {
+        size_t total = 0;
+        for (size_t i = 0; i <= shardMask; ++i) {
+            shared_lock lock(shards[i].mutex);
+            total += shards[i].entries.size();
+        }
+        return total;
+    }
+};
@@ -0,0 +1,173 @@
+#pragma once
+#include "RateLimiter.h"
+#include "Clock.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+using namespace std;
+
+// Cross-process GCRA rate limiter (POSIX shared memory)
+// Every process on the host that opens the same segment name enforces one
+// shared limit. The segment is a header plus an open-addressing table of
+// {64-bit key, TAT} slots, all lock-free atomics, so decisions are the same
+// CAS loop as GcraRateLimiter with no lock and no service round trip.
+// Keys are a 64-bit hash of the id (a collision would merge two entities'
+// buckets; at 2^16 entities the odds are ~1e-10). Slots are claimed by CAS
+// and never freed, so size slotCount for the active entity set; a full
+// table throws. Clocks must be steady_clock based (CLOCK_MONOTONIC is
+// shared by all processes), or equally offset ManualClocks in tests.
+//
+// Crash-safe initialization: opening takes flock() on the segment, which the
+// kernel releases if the holder dies. The first opener sizes the segment
+// (zero-filled, which is a valid empty table) and writes the magic number
+// last; anyone who finds no magic under the lock (a creator crashed midway)
+// simply initializes again.
+class SharedMemoryRateLimiter : public IRateLimiter {
+    static constexpr uint32_t MAGIC = 0x4C525348; // "HSRL"
+    static constexpr uint32_t VERSION = 1;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t slotCount;
+        int32_t capacity;
+    };
+    static constexpr size_t SLOTS_OFFSET = 64; // slots start on their own cache line
+    static_assert(sizeof(Header) <= SLOTS_OFFSET);
+
+    struct Slot {
+        atomic<uint64_t> key; // 0: free
+        atomic<int64_t> tat;  // ns
+    };
+    static_assert(atomic<uint64_t>::is_always_lock_free && atomic<int64_t>::is_always_lock_free,
+                  "shared-memory atomics must be lock-free");
+
+    string name;
+    size_t mappedBytes = 0;
+    void* mapping = nullptr;
+    Header* header = nullptr;
+    Slot* slots = nullptr;
+    uint64_t slotMask = 0;
+    int capacity;
+    shared_ptr<IClock> clock;
+
+    // FNV-1a plus a finalizer: stable across processes and builds, unlike std::hash
+    static uint64_t keyOf(const string& id) {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned char c : id) {
+            h = (h ^ c) * 0x100000001b3ULL;
+        }
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        return h == 0 ? 1 : h;
+    }
+
+    atomic<int64_t>& tatFor(const string& id) {
+        uint64_t key = keyOf(id);
+        for (uint64_t probe = 0, i = key & slotMask; probe <= slotMask; ++probe, i = (i + 1) & slotMask) {
+            uint64_t current = slots[i].key.load(memory_order_acquire);
+            if (current == 0 && slots[i].key.compare_exchange_strong(current, key, memory_order_acq_rel)) {
+                return slots[i].tat; // claimed; a zero TAT is a full bucket
+            }
+            if (current == key) {
+                return slots[i].tat;
+            }
+        }
+        throw runtime_error("Shared rate limit table is full: " + name);
+    }
+
+    void initialize(uint64_t slotCount) {
+        memset(mapping, 0, mappedBytes);
+        header->version = VERSION;
+        header->slotCount = slotCount;
+        header->capacity = capacity;
+        atomic_thread_fence(memory_order_release);
+        header->magic = MAGIC; // last: marks the segment usable
+    }
+
+public:
+    // slotCount is rounded up to a power of two. Every process must pass the
+    // same slotCount and capacity; a mismatch with the segment throws.
+    SharedMemoryRateLimiter(const string& name_, uint64_t slotCount = 1 << 16, int capacity_ = 10,
+                            shared_ptr<IClock> clock_ = defaultClock())
+        : name(name_), capacity(capacity_), clock(std::move(clock_)) {
+        uint64_t count = 1;
+        while (count < slotCount) {
+            count *= 2;
+        }
+        slotMask = count - 1;
+        mappedBytes = SLOTS_OFFSET + count * sizeof(Slot);
+
+        int fd = shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
+        if (fd < 0) {
+            throw runtime_error("Cannot open shared memory: " + name);
+        }
+        if (flock(fd, LOCK_EX) != 0) {
+            close(fd);
+            throw runtime_error("Cannot lock shared memory: " + name);
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || (static_cast<size_t>(info.st_size) < mappedBytes
+                                      && ftruncate(fd, static_cast<off_t>(mappedBytes)) != 0)) {
+            close(fd);
+            throw runtime_error("Cannot size shared memory: " + name);
+        }
+        mapping = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw runtime_error("Cannot map shared memory: " + name);
+        }
+        header = static_cast<Header*>(mapping);
+        slots = reinterpret_cast<Slot*>(static_cast<char*>(mapping) + SLOTS_OFFSET);
+
+        if (header->magic != MAGIC) {
+            initialize(count);
+        }
+        bool compatible = header->version == VERSION && header->slotCount == count && header->capacity == capacity;
+        // Unlock explicitly: the mapping keeps the open file (and its flock) alive past close()
+        flock(fd, LOCK_UN);
+        close(fd);
+        if (!compatible) {
+            munmap(mapping, mappedBytes);
+            throw runtime_error("Shared memory segment has a different layout: " + name);
+        }
+    }
+
+    ~SharedMemoryRateLimiter() {
+        munmap(mapping, mappedBytes);
+    }
+
+    SharedMemoryRateLimiter(const SharedMemoryRateLimiter&) = delete;
+    SharedMemoryRateLimiter& operator=(const SharedMemoryRateLimiter&) = delete;
+
+    // Removes the segment name; processes that have it mapped keep using it
+    static void destroy(const string& name) {
+        shm_unlink(name.c_str());
+    }
+
+    bool isRequestAllowed(const IRateLimitingEntity& entity) override {
+        int64_t interval = static_cast<int64_t>(1e9 / entity.getRefillRule()->tokensPerSecond());
+        atomic<int64_t>& tat = tatFor(entity.getId());
+        int64_t now = clock->nowNanos();
+        int64_t current = tat.load(memory_order_relaxed);
+        while (true) {
+            int64_t next = max(current, now) + interval;
+            if (next - now > interval * capacity) {
+                return false;
+            }
+            if (tat.compare_exchange_weak(current, next, memory_order_relaxed)) {
+                return true;
+            }
+        }
+    }
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include "RateLimiter.h"
+#include "ShardedEntityTable.h"
+#include "Clock.h"
+#include <cstdint>
+#include <memory>
+using namespace std;
+
+// Sliding Log rate limiter implementation
+// Exact: a request is allowed if fewer than maxRequests were allowed in the
+// last windowSizeMillis. Only allowed requests are logged, so each entity
+// needs a ring of exactly maxRequests timestamps: when the ring is full the
+// oldest entry decides, and an allowed request overwrites it. An entity is
+// idle once its newest timestamp has left the window.
+class SlidingLogRateLimiter : public IRateLimiter {
+    struct Log {
+        unique_ptr<long long[]> ring; // ms, maxRequests slots
+        uint32_t head = 0;            // oldest entry once the ring is full
+        uint32_t count = 0;
+        long long idleAtMillis = 0;
+
+        bool isIdle(long long now) const {
+            return now >= idleAtMillis;
+        }
+    };
+    ShardedEntityTable<Log> logs;
+
+    int maxRequests;
+    int windowSizeMillis;
+    shared_ptr<IClock> clock;
+
+public:
+    SlidingLogRateLimiter(int maxRequests_ = 10, int windowSizeMillis_ = 5000,
+                          shared_ptr<IClock> clock_ = defaultClock())
+        : maxRequests(maxRequests_), windowSizeMillis(windowSizeMillis_), clock(std::move(clock_)) {}
+
+    bool isRequestAllowed(const IRateLimitingEntity& entity) override {
+        long long now = clock->nowMillis();
+        return logs.withEntry(entity.getId(), now, [&](Log& log) {
+            if (!log.ring) {
+                log.ring = make_unique<long long[]>(maxRequests);
+            }
+            if (log.count < static_cast<uint32_t>(maxRequests)) {
+                log.ring[log.count++] = now;
+            } else if (now - log.ring[log.head] < windowSizeMillis) {
+                return false;
+            } else {
+                log.ring[log.head] = now;
+                log.head = (log.head + 1) % maxRequests;
+            }
+            log.idleAtMillis = now + windowSizeMillis;
+            return true;
+        });
+    }
+
+    size_t evictIdle() {
+        return logs.evictIdle(clock->nowMillis());
+    }
+
+    size_t entityCount() {
+        return logs.size();
+    }
+};
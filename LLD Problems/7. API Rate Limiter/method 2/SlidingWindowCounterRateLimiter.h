@@ -0,0 +1,72 @@
+#pragma once
+#include "RateLimiter.h"
+#include "ShardedEntityTable.h"
+#include "Clock.h"
+#include <algorithm>
+#include <memory>
+using namespace std;
+
+// Sliding Window Counter rate limiter implementation
+// Keeps counts for the current and previous fixed windows and estimates the
+// requests in the last windowSizeMillis as
+//   previous * (share of the previous window still covered) + current,
+// so a burst at the end of one window also counts against the start of the
+// next one (a fixed window lets 2x maxRequests through at the boundary).
+// Memory is constant per entity; the estimate assumes the previous window's
+// requests were evenly spread. A caller that read the clock before another
+// one moved the entity into a newer window counts against that newer window
+// as of its start, so the window never moves backwards.
+class SlidingWindowCounterRateLimiter : public IRateLimiter {
+    struct Counters {
+        long long windowStart = -1; // ms, aligned to windowSizeMillis; -1: no request yet
+        int previousCount = 0;
+        int currentCount = 0;
+        long long idleAtMillis = 0; // both windows have slid past
+
+        bool isIdle(long long now) const {
+            return now >= idleAtMillis;
+        }
+    };
+    ShardedEntityTable<Counters> counters;
+
+    int maxRequests;
+    int windowSizeMillis;
+    shared_ptr<IClock> clock;
+
+public:
+    SlidingWindowCounterRateLimiter(int maxRequests_ = 10, int windowSizeMillis_ = 5000,
+                                    shared_ptr<IClock> clock_ = defaultClock())
+        : maxRequests(maxRequests_), windowSizeMillis(windowSizeMillis_), clock(std::move(clock_)) {}
+
+    bool isRequestAllowed(const IRateLimitingEntity& entity) override {
+        long long now = clock->nowMillis();
+        long long windowStart = now - now % windowSizeMillis;
+
+        return counters.withEntry(entity.getId(), now, [&](Counters& c) {
+            if (windowStart > c.windowStart) {
+                // Only the window right before this one still overlaps the last windowSizeMillis
+                c.previousCount = windowStart - c.windowStart == windowSizeMillis ? c.currentCount : 0;
+                c.currentCount = 0;
+                c.windowStart = windowStart;
+                c.idleAtMillis = windowStart + 2LL * windowSizeMillis;
+            }
+
+            long long at = max(now, c.windowStart);
+            double previousWeight = 1.0 - static_cast<double>(at - c.windowStart) / windowSizeMillis;
+            double estimated = c.previousCount * previousWeight + c.currentCount;
+            if (estimated + 1 > maxRequests) {
+                return false;
+            }
+            c.currentCount++;
+            return true;
+        });
+    }
+
+    size_t evictIdle() {
+        return counters.evictIdle(clock->nowMillis());
+    }
+
+    size_t entityCount() {
+        return counters.size();
+    }
+};
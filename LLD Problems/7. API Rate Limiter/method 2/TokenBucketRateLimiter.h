@@ -0,0 +1,53 @@
+#pragma once
+#include "RateLimiter.h"
+#include "ShardedEntityTable.h"
+#include "TokensBucket.h"
+#include "Clock.h"
+#include <memory>
+using namespace std;
+
+// Token Bucket rate limiter implementation
+// Buckets live in a ShardedEntityTable, so decisions are thread-safe and a
+// bucket is dropped once it has refilled completely.
+class TokenBucketRateLimiter : public IRateLimiter {
+    struct BucketState {
+        TokensBucket bucket{10}; // capacity 10 tokens for demo
+        long long fullAtMillis = 0;
+
+        bool isIdle(long long now) const {
+            return now >= fullAtMillis;
+        }
+    };
+    ShardedEntityTable<BucketState> buckets;
+    shared_ptr<IClock> clock;
+
+public:
+    TokenBucketRateLimiter(shared_ptr<IClock> clock_ = defaultClock())
+        : clock(std::move(clock_)) {}
+
+    bool isRequestAllowed(const IRateLimitingEntity& entity) override {
+        shared_ptr<IRefillRule> rule = entity.getRefillRule();
+        long long now = clock->nowMillis();
+        return buckets.withEntry(entity.getId(), now, [&](BucketState& state) {
+            TokensBucket& bucket = state.bucket;
+
+            // Refill bucket based on entity's refill rule
+            rule->refillBucket(bucket, now);
+
+            bool allowed = bucket.hasToken();
+            if (allowed) {
+                bucket.consumeToken();
+            }
+            state.fullAtMillis = rule->fullAtMillis(bucket);
+            return allowed;
+        });
+    }
+
+    size_t evictIdle() {
+        return buckets.evictIdle(clock->nowMillis());
+    }
+
+    size_t entityCount() {
+        return buckets.size();
+    }
+};
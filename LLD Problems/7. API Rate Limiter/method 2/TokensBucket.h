@@ -0,0 +1,42 @@
+#pragma once
+#include <algorithm>
+using namespace std;
+
+// Token bucket class
+class TokensBucket {
+    int capacity;
+    int tokens;
+    long long lastRefillMillis = -1; // -1 until the refill rule first sees it
+
+public:
+    TokensBucket(int capacity_)
+        : capacity(capacity_), tokens(capacity_) {}
+
+    bool hasToken() const {
+        return tokens > 0;
+    }
+
+    void consumeToken() {
+        if (tokens > 0) --tokens;
+    }
+
+    void refill(int count) {
+        tokens = min(capacity, tokens + count);
+    }
+
+    int getTokens() const {
+        return tokens;
+    }
+
+    int getCapacity() const {
+        return capacity;
+    }
+
+    long long getLastRefillMillis() const {
+        return lastRefillMillis;
+    }
+
+    void setLastRefillMillis(long long millis) {
+        lastRefillMillis = millis;
+    }
+};
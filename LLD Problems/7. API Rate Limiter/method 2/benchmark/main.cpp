@@ -0,0 +1,387 @@
+// Rate limiter benchmark: memory per entity, decisions/sec, sampled
+// latency percentiles and heap allocations per decision.
+// bytes/entity is the growth in live heap bytes (tracked by a counting
+// operator new) from building the limiter until every entity has made one
+// request, divided by the entity count; "MB after" is what the limiter still holds once the run is
+// over, so idle eviction shows up there. Decisions pick entities by
+// --distribution (uniform, zipf with --zipf-alpha, or hot: a single key)
+// and are split across --threads threads sharing one limiter. The "GCRA
+// handles" rows intern every entity before building the limiter and decide
+// by EntityHandle. "... coarse" rows read a CoarseClock instead of
+// steady_clock on every decision.
+// --simulate-hours H runs every limiter on a ManualClock that the decision
+// loop advances so the trace spans H hours: allowed counts and memory then
+// reflect hours of refills and idle sweeps, while decisions/sec pays for
+// the shared clock's atomic add. With several threads, one that is
+// preempted between reading the clock and deciding sees simulated time
+// jump, so exact allowed counts need --threads 1.
+// --limiters restricts the run to a comma-separated list of row names.
+// --processes P additionally forks P workers that share --hot-entities users
+// through SharedMemoryRateLimiter, against P workers with private limiters.
+//
+// Build: g++ -std=c++20 -O2 -pthread main.cpp -o bench.out
+// Run:   ./bench.out --entities 100000 --ops 5000000
+//        ./bench.out --entities 1 --distribution hot --threads 8
+//        ./bench.out --entities 10000000 --limiters GCRA,TokenBucket
+//        ./bench.out --distribution zipf --simulate-hours 6
+//        ./bench.out --processes 16 --hot-entities 64
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <latch>
+#include <memory>
+#include <new>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../TokenBucketRateLimiter.h"
+#include "../FixedWindowRateLimiter.h"
+#include "../GcraRateLimiter.h"
+#include "../SlidingWindowCounterRateLimiter.h"
+#include "../SlidingLogRateLimiter.h"
+#include "../InternedGcraRateLimiter.h"
+#include "../SharedMemoryRateLimiter.h"
+#include "../ReloadableGcraRateLimiter.h"
+#include <sys/wait.h>
+#include <unistd.h>
+using namespace std;
+
+// Live heap bytes and allocation count; each block carries its size in a 16-byte header
+static atomic<long long> liveBytes{0};
+static atomic<long long> allocations{0};
+
+void* operator new(size_t size) {
+    void* block = malloc(size + 16);
+    if (!block) throw bad_alloc();
+    *static_cast<size_t*>(block) = size;
+    liveBytes.fetch_add(size, memory_order_relaxed);
+    allocations.fetch_add(1, memory_order_relaxed);
+    return static_cast<char*>(block) + 16;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    void* block = static_cast<char*>(ptr) - 16;
+    liveBytes.fetch_sub(*static_cast<size_t*>(block), memory_order_relaxed);
+    free(block);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    operator delete(ptr);
+}
+
+struct BenchmarkConfig {
+    size_t entityCount = 100000;
+    size_t opCount = 5000000;
+    size_t threadCount = 1;
+    string distribution = "uniform";
+    double zipfAlpha = 0.99;
+    double simulateHours = 0;
+    string limiters; // comma-separated row names; empty: all
+    size_t processCount = 0;
+    size_t hotEntityCount = 64;
+};
+
+// Makes one decision for entity users[index]
+using Decide = function<bool(uint32_t)>;
+
+struct LimiterUnderTest {
+    string name;
+    function<Decide(shared_ptr<IClock>)> make; // a fresh limiter reading the given clock
+};
+
+// Every LATENCY_SAMPLE_EVERY-th decision is timed, so the timers' own
+// clock reads barely move decisions/sec
+constexpr size_t LATENCY_SAMPLE_EVERY = 16;
+
+uint32_t percentile(vector<uint32_t>& samples, double fraction) {
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t index = min(samples.size() - 1, static_cast<size_t>(samples.size() * fraction));
+    nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+void run(const LimiterUnderTest& limiter, const BenchmarkConfig& config, const vector<uint32_t>& trace) {
+    size_t threadCount = config.threadCount;
+    shared_ptr<ManualClock> simulated = config.simulateHours > 0 ? make_shared<ManualClock>() : nullptr;
+    long long step = simulated ? static_cast<long long>(config.simulateHours * 3600e9 / trace.size()) : 0;
+
+    // Taken before construction: the handle rows allocate their slots up front
+    long long before = liveBytes.load();
+    Decide decide = limiter.make(simulated ? shared_ptr<IClock>(simulated) : defaultClock());
+    for (uint32_t i = 0; i < config.entityCount; ++i) {
+        decide(i);
+    }
+    double bytesPerEntity = static_cast<double>(liveBytes.load() - before) / config.entityCount;
+
+    vector<vector<uint32_t>> latencies(threadCount);
+    vector<size_t> allowedPerThread(threadCount);
+    latch ready(static_cast<ptrdiff_t>(threadCount + 1));
+    vector<thread> threads;
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            size_t begin = trace.size() * t / threadCount;
+            size_t end = trace.size() * (t + 1) / threadCount;
+            vector<uint32_t>& samples = latencies[t];
+            samples.reserve((end - begin) / LATENCY_SAMPLE_EVERY + 1);
+            size_t allowed = 0;
+            ready.arrive_and_wait();
+            for (size_t i = begin; i < end; ++i) {
+                if (simulated) {
+                    simulated->advanceNanos(step);
+                }
+                if (i % LATENCY_SAMPLE_EVERY != 0) {
+                    allowed += decide(trace[i]);
+                    continue;
+                }
+                auto opStart = chrono::steady_clock::now();
+                allowed += decide(trace[i]);
+                auto opNanos = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - opStart).count();
+                samples.push_back(static_cast<uint32_t>(min<long long>(opNanos, UINT32_MAX)));
+            }
+            allowedPerThread[t] = allowed;
+        });
+    }
+    ready.arrive_and_wait();
+    long long allocationsBefore = allocations.load();
+    auto start = chrono::steady_clock::now();
+    for (auto& th : threads) {
+        th.join();
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    double allocationsPerDecision = static_cast<double>(allocations.load() - allocationsBefore) / trace.size();
+
+    vector<uint32_t> samples;
+    size_t allowed = 0;
+    long long sampleBytes = 0;
+    for (size_t t = 0; t < threadCount; ++t) {
+        sampleBytes += static_cast<long long>(latencies[t].capacity() * sizeof(uint32_t));
+        allowed += allowedPerThread[t];
+    }
+    // What the limiter holds after the run (idle sweeps included)
+    double liveMegabytes = static_cast<double>(liveBytes.load() - before - sampleBytes) / (1 << 20);
+    for (const auto& threadSamples : latencies) {
+        samples.insert(samples.end(), threadSamples.begin(), threadSamples.end());
+    }
+
+    cout << left << setw(16) << limiter.name << right << fixed << setprecision(1)
+         << setw(14) << bytesPerEntity
+         << setw(10) << liveMegabytes
+         << setw(16) << static_cast<long long>(trace.size() / seconds)
+         << setw(8) << percentile(samples, 0.50)
+         << setw(8) << percentile(samples, 0.99)
+         << setw(8) << percentile(samples, 0.999)
+         << setw(12) << setprecision(2) << allocationsPerDecision
+         << setw(12) << allowed << endl;
+}
+
+LimiterUnderTest forLimiter(const string& name, function<shared_ptr<IRateLimiter>(shared_ptr<IClock>)> makeLimiter,
+                            const vector<User>& users) {
+    return {name, [makeLimiter, &users](shared_ptr<IClock> clock) -> Decide {
+        shared_ptr<IRateLimiter> limiter = makeLimiter(std::move(clock));
+        return [limiter, &users](uint32_t index) { return limiter->isRequestAllowed(users[index]); };
+    }};
+}
+
+// Entity index per decision: "uniform" over all entities, "zipf" with
+// zipfAlpha (index 0 hottest), or "hot" for every decision on entity 0
+vector<uint32_t> generateTrace(const BenchmarkConfig& config) {
+    mt19937_64 rng(12345);
+    vector<uint32_t> trace(config.opCount);
+    if (config.distribution == "uniform") {
+        uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(config.entityCount - 1));
+        for (auto& index : trace) {
+            index = pick(rng);
+        }
+    } else if (config.distribution == "zipf") {
+        vector<double> cdf(config.entityCount);
+        double sum = 0;
+        for (size_t i = 0; i < config.entityCount; ++i) {
+            sum += 1.0 / pow(static_cast<double>(i + 1), config.zipfAlpha);
+            cdf[i] = sum;
+        }
+        uniform_real_distribution<double> uniform(0.0, sum);
+        for (auto& index : trace) {
+            size_t rank = lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+            index = static_cast<uint32_t>(min(rank, config.entityCount - 1));
+        }
+    } else if (config.distribution == "hot") {
+        fill(trace.begin(), trace.end(), 0);
+    } else {
+        throw invalid_argument("Unknown distribution: " + config.distribution);
+    }
+    return trace;
+}
+
+// Forks processCount workers that split opCount decisions over the hot users
+// (each worker builds its limiter with makeLimiter) and reports the total
+template <typename MakeLimiter>
+void runProcesses(const string& name, const BenchmarkConfig& config, const vector<User>& hotUsers,
+                  MakeLimiter makeLimiter) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        throw runtime_error("pipe failed");
+    }
+    size_t opsPerProcess = config.opCount / config.processCount;
+    auto start = chrono::steady_clock::now();
+    for (size_t p = 0; p < config.processCount; ++p) {
+        if (fork() == 0) {
+            close(fds[0]);
+            unique_ptr<IRateLimiter> limiter = makeLimiter();
+            mt19937 rng(static_cast<uint32_t>(p));
+            long long allowed = 0;
+            for (size_t i = 0; i < opsPerProcess; ++i) {
+                allowed += limiter->isRequestAllowed(hotUsers[rng() % hotUsers.size()]);
+            }
+            ssize_t written = write(fds[1], &allowed, sizeof(allowed));
+            _exit(written == sizeof(allowed) ? 0 : 1);
+        }
+    }
+    close(fds[1]);
+    long long allowed = 0;
+    for (long long childAllowed; read(fds[0], &childAllowed, sizeof(childAllowed)) == sizeof(childAllowed);) {
+        allowed += childAllowed;
+    }
+    close(fds[0]);
+    while (wait(nullptr) > 0) {}
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Users get 10 tokens up front plus one per second
+    long long limit = static_cast<long long>(hotUsers.size() * (10 + static_cast<long long>(seconds) + 1));
+    cout << left << setw(16) << name << right << setw(16)
+         << static_cast<long long>(opsPerProcess * config.processCount / seconds)
+         << setw(12) << allowed << setw(14) << limit << endl;
+}
+
+void benchmarkProcesses(const BenchmarkConfig& config) {
+    const string segment = "/lld_rate_limiter_bench";
+    vector<User> hotUsers;
+    for (size_t i = 0; i < config.hotEntityCount; ++i) {
+        hotUsers.emplace_back("hot" + to_string(i));
+    }
+
+    cout << endl << config.processCount << " processes, " << config.hotEntityCount << " shared users" << endl;
+    cout << left << setw(16) << "limiter" << right << setw(16) << "decisions/sec"
+         << setw(12) << "allowed" << setw(14) << "one limit" << endl;
+    runProcesses("per-process", config, hotUsers, [] { return make_unique<GcraRateLimiter>(); });
+    SharedMemoryRateLimiter::destroy(segment);
+    runProcesses("shared memory", config, hotUsers, [&] { return make_unique<SharedMemoryRateLimiter>(segment); });
+    SharedMemoryRateLimiter::destroy(segment);
+}
+
+BenchmarkConfig parseArgs(int argc, char* argv[]) {
+    BenchmarkConfig config;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        string flag = argv[i];
+        string value = argv[i + 1];
+        if (flag == "--entities") config.entityCount = stoull(value);
+        else if (flag == "--ops") config.opCount = stoull(value);
+        else if (flag == "--threads") config.threadCount = stoull(value);
+        else if (flag == "--distribution") config.distribution = value;
+        else if (flag == "--zipf-alpha") config.zipfAlpha = stod(value);
+        else if (flag == "--simulate-hours") config.simulateHours = stod(value);
+        else if (flag == "--limiters") config.limiters = value;
+        else if (flag == "--processes") config.processCount = stoull(value);
+        else if (flag == "--hot-entities") config.hotEntityCount = stoull(value);
+        else throw invalid_argument("Unknown flag: " + flag);
+    }
+    if (config.entityCount == 0 || config.opCount == 0 || config.threadCount == 0) {
+        throw invalid_argument("--entities, --ops and --threads must be positive");
+    }
+    return config;
+}
+
+bool isSelected(const BenchmarkConfig& config, const string& name) {
+    if (config.limiters.empty()) {
+        return true;
+    }
+    stringstream names(config.limiters);
+    for (string selected; getline(names, selected, ',');) {
+        if (selected == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkConfig config;
+    vector<uint32_t> trace;
+    try {
+        config = parseArgs(argc, argv);
+        trace = generateTrace(config);
+    } catch (const exception& ex) {
+        cerr << ex.what() << endl;
+        return 1;
+    }
+
+    vector<User> users;
+    users.reserve(config.entityCount);
+    for (size_t i = 0; i < config.entityCount; ++i) {
+        users.emplace_back("user" + to_string(i));
+    }
+
+    vector<LimiterUnderTest> limiters = {
+        forLimiter("TokenBucket", [](auto clock) { return make_shared<TokenBucketRateLimiter>(clock); }, users),
+        forLimiter("FixedWindow", [](auto clock) { return make_shared<FixedWindowRateLimiter>(clock); }, users),
+        forLimiter("GCRA", [](auto clock) { return make_shared<GcraRateLimiter>(10, clock); }, users),
+        forLimiter("SlidingCounter", [](auto clock) { return make_shared<SlidingWindowCounterRateLimiter>(10, 5000, clock); }, users),
+        forLimiter("SlidingLog", [](auto clock) { return make_shared<SlidingLogRateLimiter>(10, 5000, clock); }, users),
+        forLimiter("GCRA reloadable", [](auto clock) { return make_shared<ReloadableGcraRateLimiter>(RuleTable(), 10, clock); }, users),
+    };
+
+    // Interning happens before the run, as it would at session start
+    auto registry = make_shared<EntityRegistry>();
+    vector<EntityHandle> handles;
+    if (isSelected(config, "GCRA handles") || isSelected(config, "handles coarse")) {
+        handles.reserve(users.size());
+        for (const User& user : users) {
+            handles.push_back(registry->intern(user));
+        }
+    }
+    auto forHandles = [&](const string& name, function<shared_ptr<IClock>(shared_ptr<IClock>)> pickClock) {
+        return LimiterUnderTest{name, [&, pickClock](shared_ptr<IClock> clock) -> Decide {
+            auto limiter = make_shared<InternedGcraRateLimiter>(registry, 10, pickClock(std::move(clock)));
+            return [limiter, &handles](uint32_t index) { return limiter->isRequestAllowed(handles[index]); };
+        }};
+    };
+    limiters.push_back(forHandles("GCRA handles", [](auto clock) { return clock; }));
+
+    // A coarse clock only means something in real time
+    shared_ptr<CoarseClock> coarseClock;
+    if (config.simulateHours == 0) {
+        coarseClock = make_shared<CoarseClock>();
+        limiters.push_back(forLimiter("GCRA coarse", [&](auto) { return make_shared<GcraRateLimiter>(10, coarseClock); }, users));
+        limiters.push_back(forHandles("handles coarse", [&](auto) -> shared_ptr<IClock> { return coarseClock; }));
+    }
+
+    cout << config.entityCount << " entities (" << config.distribution << "), " << config.opCount
+         << " decisions on " << config.threadCount << " thread(s), limit 10 per 5 s";
+    if (config.simulateHours > 0) {
+        cout << ", " << config.simulateHours << " simulated hours";
+    }
+    cout << endl;
+    cout << left << setw(16) << "limiter" << right << setw(14) << "bytes/entity" << setw(10) << "MB after"
+         << setw(16) << "decisions/sec" << setw(8) << "p50 ns" << setw(8) << "p99 ns" << setw(8) << "p999 ns"
+         << setw(12) << "allocs/dec" << setw(12) << "allowed" << endl;
+    for (const LimiterUnderTest& limiter : limiters) {
+        if (isSelected(config, limiter.name)) {
+            run(limiter, config, trace);
+        }
+    }
+
+    if (config.processCount > 0) {
+        benchmarkProcesses(config);
+    }
+    return 0;
+}
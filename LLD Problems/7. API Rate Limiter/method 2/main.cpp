@@ -1,200 +1,29 @@
 #include <iostream>
 #include <string>
 #include <memory>
-#include <unordered_map>
 #include <chrono>
 #include <thread>
-#include <algorithm>
+#include <vector>
+#include <atomic>
+#include <sstream>
+#include "TokenBucketRateLimiter.h"
+#include "FixedWindowRateLimiter.h"
+#include "GcraRateLimiter.h"
+#include "SlidingWindowCounterRateLimiter.h"
+#include "SlidingLogRateLimiter.h"
+#include "InternedGcraRateLimiter.h"
+#include "SharedMemoryRateLimiter.h"
+#include "AsyncRateLimiter.h"
+#include "ReloadableGcraRateLimiter.h"
 using namespace std;
 
-// Forward declarations
-class TokensBucket;
-
-// Interface for refill rule
-class IRefillRule {
-public:
-    virtual void refillBucket(TokensBucket& bucket, const string& entityId) = 0;
-    virtual ~IRefillRule() = default;
-};
-
-// Token bucket class
-class TokensBucket {
-    int capacity;
-    int tokens;
-
-public:
-    TokensBucket(int capacity_)
-        : capacity(capacity_), tokens(capacity_) {}
-
-    bool hasToken() const {
-        return tokens > 0;
-    }
-
-    void consumeToken() {
-        if (tokens > 0) --tokens;
-    }
-
-    void refill(int count) {
-        tokens = min(capacity, tokens + count);
-    }
-};
-
-// Constant rate refill rule for token bucket
-class ConstantRateRefillRule : public IRefillRule {
-    int tokensToAdd;
-    int windowMillis;
-    unordered_map<string, long long> lastRefillMap;
-
-    long long nowMillis() const {
-        return chrono::duration_cast<chrono::milliseconds>(
-            chrono::steady_clock::now().time_since_epoch()).count();
-    }
-
-public:
-    ConstantRateRefillRule(int tokensToAdd_, int windowMillis_)
-        : tokensToAdd(tokensToAdd_), windowMillis(windowMillis_) {}
-
-    void refillBucket(TokensBucket& bucket, const string& entityId) override {
-        long long now = nowMillis();
-
-        auto it = lastRefillMap.find(entityId);
-        if (it == lastRefillMap.end()) {
-            lastRefillMap[entityId] = now;
-            return;
-        }
-
-        long long& lastRefill = it->second;
-        if (now - lastRefill >= windowMillis) {
-            bucket.refill(tokensToAdd);
-            lastRefill = now;
-        }
-    }
-};
-
-// Interface for entities subject to rate limiting
-class IRateLimitingEntity {
-public:
-    virtual string getId() const = 0;
-    virtual shared_ptr<IRefillRule> getRefillRule() const = 0;
-    virtual ~IRateLimitingEntity() = default;
-};
-
-// User entity
-class User : public IRateLimitingEntity {
-    string userId;
-    shared_ptr<IRefillRule> refillRule;
-
-public:
-    User(const string& id)
-        : userId(id),
-          refillRule(make_shared<ConstantRateRefillRule>(5, 5000)) // 5 tokens per 5 seconds
-    {}
-
-    string getId() const override {
-        return userId;
-    }
-
-    shared_ptr<IRefillRule> getRefillRule() const override {
-        return refillRule;
-    }
-};
-
-// API entity
-class API : public IRateLimitingEntity {
-    string apiName;
-    shared_ptr<IRefillRule> refillRule;
-
-public:
-    API(const string& name)
-        : apiName(name),
-          refillRule(make_shared<ConstantRateRefillRule>(3, 3000)) // 3 tokens per 3 seconds
-    {}
-
-    string getId() const override {
-        return apiName;
-    }
-
-    shared_ptr<IRefillRule> getRefillRule() const override {
-        return refillRule;
-    }
-};
-
-// Interface for rate limiter algorithms
-class IRateLimiter {
-public:
-    virtual bool isRequestAllowed(const IRateLimitingEntity& entity) = 0;
-    virtual ~IRateLimiter() = default;
-};
-
-// Token Bucket rate limiter implementation
-class TokenBucketRateLimiter : public IRateLimiter {
-    unordered_map<string, TokensBucket> buckets;
-
-public:
-    bool isRequestAllowed(const IRateLimitingEntity& entity) override {
-        string id = entity.getId();
-
-        if (buckets.find(id) == buckets.end()) {
-            buckets.emplace(id, TokensBucket(10)); // capacity 10 tokens for demo
-        }
-
-        TokensBucket& bucket = buckets.at(id);
-
-        // Refill bucket based on entity's refill rule
-        entity.getRefillRule()->refillBucket(bucket, id);
-
-        if (!bucket.hasToken()) {
-            return false;
-        }
-
-        bucket.consumeToken();
-        return true;
-    }
-};
-
-// Fixed Window rate limiter implementation
-class FixedWindowRateLimiter : public IRateLimiter {
-    struct Window {
-        long long windowStart; // ms
-        int count;
-    };
-    unordered_map<string, Window> windows;
-
-    const int maxRequests = 10;
-    const int windowSizeMillis = 5000;
-
-    long long nowMillis() const {
-        return chrono::duration_cast<chrono::milliseconds>(
-            chrono::steady_clock::now().time_since_epoch()).count();
-    }
-
-public:
-    bool isRequestAllowed(const IRateLimitingEntity& entity) override {
-        string id = entity.getId();
-        long long now = nowMillis();
-
-        auto it = windows.find(id);
-        if (it == windows.end() || now - it->second.windowStart >= windowSizeMillis) {
-            // Start a new window
-            windows[id] = { now, 1 };
-            return true;
-        }
-
-        Window& window = windows[id];
-        if (window.count < maxRequests) {
-            window.count++;
-            return true;
-        }
-
-        return false;
-    }
-};
-
 int main() {
     User user("user123");
     API api("getPosts");
 
-    unique_ptr<IRateLimiter> tokenBucketLimiter = make_unique<TokenBucketRateLimiter>();
+    // A manual clock makes the refill below deterministic and instant
+    auto clock = make_shared<ManualClock>();
+    unique_ptr<IRateLimiter> tokenBucketLimiter = make_unique<TokenBucketRateLimiter>(clock);
     unique_ptr<IRateLimiter> fixedWindowLimiter = make_unique<FixedWindowRateLimiter>();
 
     cout << "Using Token Bucket Rate Limiter\n";
@@ -205,8 +34,8 @@ int main() {
                   << "API request #" << i << " allowed: " << (allowedApi ? "Yes" : "No") << "\n";
     }
 
-    cout << "\nWaiting 6 seconds to allow refill...\n\n";
-    this_thread::sleep_for(chrono::seconds(6));
+    cout << "\nAdvancing the clock 6 seconds to allow refill...\n\n";
+    clock->advanceMillis(6000);
 
     for (int i = 1; i <= 7; ++i) {
         bool allowedUser = tokenBucketLimiter->isRequestAllowed(user);
@@ -223,5 +52,188 @@ int main() {
                   << "API request #" << i << " allowed: " << (allowedApi ? "Yes" : "No") << "\n";
     }
 
+    unique_ptr<IRateLimiter> slidingCounterLimiter = make_unique<SlidingWindowCounterRateLimiter>();
+    unique_ptr<IRateLimiter> slidingLogLimiter = make_unique<SlidingLogRateLimiter>();
+
+    cout << "\nUsing Sliding Window Counter and Sliding Log Rate Limiters\n";
+    for (int i = 1; i <= 15; ++i) {
+        bool allowedCounter = slidingCounterLimiter->isRequestAllowed(user);
+        bool allowedLog = slidingLogLimiter->isRequestAllowed(user);
+        cout << "User request #" << i << " allowed (counter): " << (allowedCounter ? "Yes" : "No") << ", "
+                  << "allowed (log): " << (allowedLog ? "Yes" : "No") << "\n";
+    }
+
+    // A request must pass the user, API and user x API limits together
+    cout << "\nUsing GCRA checkAll for user, API and user x API\n";
+    GcraRateLimiter hierarchyLimiter;
+    User alice("alice");
+    API search("search");
+    UserPerAPI aliceSearch(alice, search);
+    for (int i = 0; i < 8; ++i) {
+        hierarchyLimiter.isRequestAllowed(aliceSearch); // leaves 2 tokens at user x API
+    }
+    bool allowedAll = hierarchyLimiter.checkAll({&alice, &search, &aliceSearch}, 3);
+    cout << "Request costing 3 allowed: " << (allowedAll ? "Yes" : "No") << "\n";
+    int userTokens = 0;
+    for (int i = 0; i < 12; ++i) {
+        userTokens += hierarchyLimiter.isRequestAllowed(alice);
+    }
+    cout << "User level still had " << userTokens << " tokens (none leaked by the rejection)\n";
+
+    // Two limiters on one shared-memory segment stand in for two worker
+    // processes: together they still allow only 10 requests
+    cout << "\nUsing Shared Memory Rate Limiter from two workers\n";
+    SharedMemoryRateLimiter::destroy("/lld_rate_limiter_demo");
+    {
+        SharedMemoryRateLimiter workerA("/lld_rate_limiter_demo");
+        SharedMemoryRateLimiter workerB("/lld_rate_limiter_demo");
+        User bob("bob");
+        int allowedA = 0, allowedB = 0;
+        for (int i = 0; i < 8; ++i) {
+            allowedA += workerA.isRequestAllowed(bob);
+            allowedB += workerB.isRequestAllowed(bob);
+        }
+        cout << "Worker A allowed " << allowedA << ", worker B allowed " << allowedB << " (shared capacity 10)\n";
+    }
+    SharedMemoryRateLimiter::destroy("/lld_rate_limiter_demo");
+
+    // Resolve entities to handles once at setup; the hot path then indexes a flat array
+    cout << "\nUsing Interned GCRA Rate Limiter\n";
+    auto registry = make_shared<EntityRegistry>();
+    EntityHandle userHandle = registry->intern(User("user789"));
+    EntityHandle apiHandle = registry->intern(API("getComments"));
+    EntityHandle sharedHandle = registry->intern(User("user321"));
+    InternedGcraRateLimiter internedLimiter(registry);
+    for (int i = 1; i <= 12; ++i) {
+        bool allowedUser = internedLimiter.isRequestAllowed(userHandle);
+        bool allowedApi = internedLimiter.isRequestAllowed(apiHandle);
+        cout << "User request #" << i << " allowed: " << (allowedUser ? "Yes" : "No") << ", "
+                  << "API request #" << i << " allowed: " << (allowedApi ? "Yes" : "No") << "\n";
+    }
+    atomic<int> internedAllowed{0};
+    vector<thread> internedThreads;
+    for (int t = 0; t < 4; ++t) {
+        internedThreads.emplace_back([&] {
+            for (int i = 0; i < 5; ++i) {
+                internedAllowed += internedLimiter.isRequestAllowed(sharedHandle);
+            }
+        });
+    }
+    for (auto& t : internedThreads) t.join();
+    cout << "4 threads on one handle allowed " << internedAllowed << " of 20 (capacity 10)\n";
+
+    // GCRA decisions are lock-free, so one limiter can be shared by threads
+    cout << "\nUsing GCRA Rate Limiter from 8 threads\n";
+    GcraRateLimiter gcraLimiter(10, clock);
+    User sharedUser("user456");
+    atomic<int> allowed{0};
+    vector<thread> threads;
+    for (int t = 0; t < 8; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 50; ++i) {
+                if (gcraLimiter.isRequestAllowed(sharedUser)) allowed++;
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    cout << "Allowed " << allowed << " of 400 concurrent requests (capacity 10)\n";
+
+    // One request leaves a GCRA bucket one emission interval (1 s for a User)
+    // short of full, so after a second idle entities can be forgotten
+    for (int i = 0; i < 1000; ++i) {
+        gcraLimiter.isRequestAllowed(User("visitor" + to_string(i)));
+    }
+    cout << "GCRA tracks " << gcraLimiter.entityCount() << " entities\n";
+    clock->advanceMillis(1100);
+    cout << "Evicted " << gcraLimiter.evictIdle() << " idle entities\n";
+
+    // New entities grow the table while a sweep rebuilds it; none of them is
+    // idle yet, so every one must survive both
+    atomic<bool> crowdDone{false};
+    thread sweeper([&] {
+        while (!crowdDone) gcraLimiter.evictIdle();
+    });
+    vector<thread> crowd;
+    for (int t = 0; t < 4; ++t) {
+        crowd.emplace_back([&, t] {
+            for (int i = 0; i < 2000; ++i) {
+                gcraLimiter.isRequestAllowed(User("crowd" + to_string(t) + "-" + to_string(i)));
+            }
+        });
+    }
+    for (auto& th : crowd) th.join();
+    crowdDone = true;
+    sweeper.join();
+    cout << "GCRA tracks " << gcraLimiter.entityCount() << " entities after 8000 concurrent arrivals\n";
+
+    // Instead of rejecting, acquire() queues callers until their tokens refill
+    // (1 per second for a User), in arrival order
+    cout << "\nUsing Async Rate Limiter (capacity 2)\n";
+    auto shapingClock = make_shared<ManualClock>();
+    AsyncRateLimiter asyncLimiter(2, 100, shapingClock);
+    User carol("carol");
+    vector<future<void>> admissions;
+    for (int i = 0; i < 4; ++i) {
+        admissions.push_back(asyncLimiter.acquire(carol));
+    }
+    auto isReady = [](future<void>& admission) {
+        return admission.wait_for(chrono::seconds(0)) == future_status::ready ? "ready" : "waiting";
+    };
+    for (int i = 0; i < 4; ++i) {
+        cout << "Request #" << i + 1 << ": " << isReady(admissions[i]) << "\n";
+    }
+    shapingClock->advanceMillis(1000);
+    asyncLimiter.poll();
+    admissions[2].wait();
+    cout << "After 1 s: request #3 " << isReady(admissions[2]) << ", request #4 " << isReady(admissions[3]) << "\n";
+    bool admitted = asyncLimiter.tryAcquireFor(carol, 1, chrono::milliseconds(500));
+    cout << "tryAcquireFor with a 500 ms timeout (next token in 2 s): " << (admitted ? "Yes" : "No") << "\n";
+    shapingClock->advanceMillis(1000);
+    asyncLimiter.poll();
+    admissions[3].wait();
+    cout << "After 2 s: request #4 ready, " << asyncLimiter.waiterCount() << " still queued\n";
+
+    // Limits come from a rule table that can be swapped under live traffic;
+    // buckets keep their fill ratio across the change
+    cout << "\nUsing Reloadable GCRA Rate Limiter\n";
+    istringstream initialRules("user 10 5 5000\napi 3 3 3000\n");
+    ReloadableGcraRateLimiter reloadableLimiter(RuleTable::parse(initialRules), 10, shapingClock);
+    User dave("dave");
+    for (int i = 0; i < 5; ++i) {
+        reloadableLimiter.isRequestAllowed(dave);
+    }
+    cout << "Spent 5 of 10 user tokens\n";
+    istringstream doubledRules("# doubled for a launch\nuser 20 10 5000\napi 3 3 3000\n");
+    reloadableLimiter.reload(RuleTable::parse(doubledRules));
+    int remaining = 0;
+    while (reloadableLimiter.isRequestAllowed(dave)) {
+        ++remaining;
+    }
+    cout << "After reload to capacity 20 (rules v" << reloadableLimiter.rulesVersion() << "): "
+              << remaining << " tokens left\n";
+
+    // Back-to-back reloads while 4 threads decide; each replaced table is
+    // freed once the decisions reading it have finished, so a decision
+    // pinned late must still keep its table alive
+    atomic<bool> reloading{true};
+    vector<thread> deciders;
+    for (int t = 0; t < 4; ++t) {
+        deciders.emplace_back([&, t] {
+            User reader("reader" + to_string(t));
+            while (reloading) {
+                reloadableLimiter.isRequestAllowed(reader);
+                this_thread::yield(); // lets reload() run on a single core
+            }
+        });
+    }
+    for (int i = 0; i < 5000; ++i) {
+        istringstream rules("user " + to_string(10 + i % 10) + " 10 5000\nuser:reader" + to_string(i % 4)
+                            + " 30 30 5000\n");
+        reloadableLimiter.reload(RuleTable::parse(rules));
+    }
+    reloading = false;
+    for (auto& t : deciders) t.join();
+    cout << "5000 reloads under 4 deciding threads, now at rules v" << reloadableLimiter.rulesVersion() << "\n";
+
     return 0;
 }